@@ -0,0 +1,181 @@
+#include "alpha-blend.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ALPHA_BLEND_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define ALPHA_BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+// round(v / 255) for v in [0, 65025]
+static inline uint32_t div255(uint32_t v) {
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+// Straight-alpha "source over destination" for one pixel:
+//   out_a = sa + da * (1 - sa)
+//   out_c = (sc * sa + dc * da * (1 - sa)) / out_a
+// The common cases (opaque or empty source, empty or opaque canvas) skip
+// the division; the general case divides exactly in integers.
+static inline void blend_pixel_over(uint8_t* d, const uint8_t* s) {
+    uint32_t sa = s[3];
+    if (sa == 255) {
+        memcpy(d, s, 4);
+        return;
+    }
+    if (sa == 0) return;
+
+    uint32_t da = d[3];
+    if (da == 0) {
+        memcpy(d, s, 4);
+        return;
+    }
+
+    uint32_t inv = 255 - sa;
+    if (da == 255) {
+        for (int c = 0; c < 3; c++)
+            d[c] = (uint8_t)div255(s[c] * sa + d[c] * inv);
+        return;
+    }
+
+    // Everything scaled by 255 * 255 to stay in integers
+    uint32_t a = sa * 255 + da * inv;
+    for (int c = 0; c < 3; c++)
+        d[c] = (uint8_t)((s[c] * sa * 255 + d[c] * da * inv + a / 2) / a);
+    d[3] = (uint8_t)div255(a);
+}
+
+static void blend_row_over_scalar(uint8_t* dst, const uint8_t* src, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++)
+        blend_pixel_over(dst + i * 4, src + i * 4);
+}
+
+#if defined(ALPHA_BLEND_SSE2)
+
+// Blends two pixels (unpacked to 16 bits) onto an opaque canvas:
+// round((s * sa + d * (255 - sa)) / 255)
+static inline __m128i blend_opaque_16(__m128i s, __m128i d) {
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    __m128i v = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+// Four pixels at a time. Groups whose pixels all take the same shortcut
+// (opaque or empty source, empty or opaque canvas) are done in registers;
+// mixed groups along shape edges fall back to the scalar pixel.
+void blend_row_over(uint8_t* dst, const uint8_t* src, size_t pixels) {
+    const __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i sa = _mm_and_si128(s, alpha_mask);
+        __m128i s_opaque = _mm_cmpeq_epi32(sa, alpha_mask);
+        __m128i s_empty = _mm_cmpeq_epi32(sa, zero);
+
+        if (_mm_movemask_epi8(s_opaque) == 0xFFFF) {
+            _mm_storeu_si128((__m128i*)(dst + i * 4), s);
+            continue;
+        }
+        if (_mm_movemask_epi8(s_empty) == 0xFFFF) continue;
+
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i * 4));
+        __m128i da = _mm_and_si128(d, alpha_mask);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(da, zero)) == 0xFFFF) {
+            // Empty canvas: take the source unless it is empty too
+            __m128i out = _mm_or_si128(_mm_and_si128(s_empty, d), _mm_andnot_si128(s_empty, s));
+            _mm_storeu_si128((__m128i*)(dst + i * 4), out);
+            continue;
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(da, alpha_mask)) == 0xFFFF) {
+            __m128i lo = blend_opaque_16(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+            __m128i hi = blend_opaque_16(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+            __m128i out = _mm_or_si128(_mm_packus_epi16(lo, hi), alpha_mask);
+            _mm_storeu_si128((__m128i*)(dst + i * 4), out);
+            continue;
+        }
+
+        blend_row_over_scalar(dst + i * 4, src + i * 4, 4);
+    }
+    blend_row_over_scalar(dst + i * 4, src + i * 4, pixels - i);
+}
+
+#elif defined(ALPHA_BLEND_NEON)
+
+// Eight pixels at a time, deinterleaved into R, G, B, A registers. Same
+// shortcuts as the SSE2 path; mixed groups use the scalar pixel.
+void blend_row_over(uint8_t* dst, const uint8_t* src, size_t pixels) {
+    const uint8x8_t full = vdup_n_u8(255);
+    const uint8x8_t none = vdup_n_u8(0);
+
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint8x8x4_t s = vld4_u8(src + i * 4);
+        uint8x8_t s_opaque = vceq_u8(s.val[3], full);
+        uint8x8_t s_empty = vceq_u8(s.val[3], none);
+
+        if (vget_lane_u64(vreinterpret_u64_u8(s_opaque), 0) == ~0ULL) {
+            vst4_u8(dst + i * 4, s);
+            continue;
+        }
+        if (vget_lane_u64(vreinterpret_u64_u8(s_empty), 0) == ~0ULL) continue;
+
+        uint8x8x4_t d = vld4_u8(dst + i * 4);
+
+        if (vget_lane_u64(vreinterpret_u64_u8(vceq_u8(d.val[3], none)), 0) == ~0ULL) {
+            // Empty canvas: take the source unless it is empty too
+            for (int c = 0; c < 4; c++)
+                d.val[c] = vbsl_u8(s_empty, d.val[c], s.val[c]);
+            vst4_u8(dst + i * 4, d);
+            continue;
+        }
+
+        if (vget_lane_u64(vreinterpret_u64_u8(vceq_u8(d.val[3], full)), 0) == ~0ULL) {
+            uint8x8_t inv = vsub_u8(full, s.val[3]);
+            for (int c = 0; c < 3; c++) {
+                uint16x8_t v = vmlal_u8(vmull_u8(s.val[c], s.val[3]), d.val[c], inv);
+                v = vaddq_u16(v, vdupq_n_u16(128));
+                d.val[c] = vshrn_n_u16(vaddq_u16(v, vshrq_n_u16(v, 8)), 8);
+            }
+            vst4_u8(dst + i * 4, d);
+            continue;
+        }
+
+        blend_row_over_scalar(dst + i * 4, src + i * 4, 8);
+    }
+    blend_row_over_scalar(dst + i * 4, src + i * 4, pixels - i);
+}
+
+#else
+
+void blend_row_over(uint8_t* dst, const uint8_t* src, size_t pixels) {
+    blend_row_over_scalar(dst, src, pixels);
+}
+
+#endif
+
+void composite_rect(uint8_t* canvas, uint32_t cw, uint32_t ch,
+                    const uint8_t* src, uint32_t fw, uint32_t fh,
+                    uint32_t x, uint32_t y, BlendOp op) {
+    if (x >= cw || y >= ch) return;
+    size_t w = fw < cw - x ? fw : cw - x;
+    size_t h = fh < ch - y ? fh : ch - y;
+
+    for (size_t row = 0; row < h; row++) {
+        uint8_t* d = canvas + ((y + row) * (size_t)cw + x) * 4;
+        const uint8_t* s = src ? src + row * (size_t)fw * 4 : nullptr;
+
+        switch (op) {
+        case BlendOp::SOURCE: memcpy(d, s, w * 4); break;
+        case BlendOp::OVER:   blend_row_over(d, s, w); break;
+        case BlendOp::CLEAR:  memset(d, 0, w * 4); break;
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Row kernels for compositing straight-alpha RGBA8 animation frames onto a
+// canvas. OVER uses exact integer math (rounded to nearest), so the SSE2,
+// NEON and scalar paths produce identical pixels.
+
+enum class BlendOp {
+    SOURCE, // Replace canvas pixels (APNG_BLEND_OP_SOURCE)
+    OVER,   // Alpha-composite over the canvas (APNG_BLEND_OP_OVER)
+    CLEAR   // Transparent black, `src` unused (APNG_DISPOSE_OP_BACKGROUND)
+};
+
+void blend_row_over(uint8_t* dst, const uint8_t* src, size_t pixels);
+
+// Applies `op` to the fw x fh frame at (x, y) on a cw x ch canvas. The
+// rectangle is clipped to the canvas once, then processed row by row.
+void composite_rect(uint8_t* canvas, uint32_t cw, uint32_t ch,
+                    const uint8_t* src, uint32_t fw, uint32_t fh,
+                    uint32_t x, uint32_t y, BlendOp op);
@@ -1,7 +1,13 @@
 #include "apng-decoder.h"
+#include "image-format.h"
+#include "alpha-blend.h"
+#include "png-inflate.h"
 #include <util/platform.h>
 #include <obs-module.h>
-#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
 
 #define BLOG(level, format, ...) blog(level, "[APNG-Decoder] " format, ##__VA_ARGS__)
 
@@ -13,97 +19,153 @@ static uint16_t read_u16(const unsigned char* p) {
     return (p[0] << 8) | p[1];
 }
 
-// Helper to write big-endian integers
-static void set_u32_be(unsigned char* p, uint32_t val) {
-    p[0] = (unsigned char)((val >> 24) & 0xFF);
-    p[1] = (unsigned char)((val >> 16) & 0xFF);
-    p[2] = (unsigned char)((val >> 8) & 0xFF);
-    p[3] = (unsigned char)(val & 0xFF);
+// Allowed bit depths per color type (PNG spec, table 11.1)
+static bool png_color_valid(LodePNGColorType type, unsigned depth) {
+    switch (type) {
+    case LCT_GREY:    return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+    case LCT_PALETTE: return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+    case LCT_RGB:
+    case LCT_GREY_ALPHA:
+    case LCT_RGBA:    return depth == 8 || depth == 16;
+    default:          return false;
+    }
 }
 
-APNGDecoder::APNGDecoder() {}
-
-APNGDecoder::~APNGDecoder() {
-    Free();
+static unsigned char paeth(short a, short b, short c) {
+    short pa = (short)abs(b - c);
+    short pb = (short)abs(a - c);
+    short pc = (short)abs(a + b - c - c);
+    if (pc < pa && pc < pb) return (unsigned char)c;
+    if (pb < pa) return (unsigned char)b;
+    return (unsigned char)a;
 }
 
-void APNGDecoder::Free() {
-    for (auto& f : frames) {
-        if (f.texture) {
-            obs_enter_graphics();
-            gs_texture_destroy(f.texture);
-            obs_leave_graphics();
+// Reverses the per-scanline filters of one (sub)image in place. `data` holds
+// h rows of [filter byte][line_bytes]; the result is h packed rows of
+// line_bytes at the start of `data`. Each output row ends before the input
+// row it came from, so overwriting as we go is safe.
+static bool unfilter(unsigned char* data, size_t w, size_t h, unsigned bpp) {
+    size_t bytewidth = (bpp + 7) / 8;
+    size_t line_bytes = (w * bpp + 7) / 8;
+    const unsigned char* prev = nullptr;
+
+    for (size_t y = 0; y < h; y++) {
+        unsigned char filter = data[y * (line_bytes + 1)];
+        const unsigned char* in = data + y * (line_bytes + 1) + 1;
+        unsigned char* out = data + y * line_bytes;
+        size_t i;
+
+        switch (filter) {
+        case 0: // None
+            memmove(out, in, line_bytes);
+            break;
+        case 1: // Sub
+            for (i = 0; i < bytewidth && i < line_bytes; i++) out[i] = in[i];
+            for (; i < line_bytes; i++) out[i] = in[i] + out[i - bytewidth];
+            break;
+        case 2: // Up
+            if (prev) {
+                for (i = 0; i < line_bytes; i++) out[i] = in[i] + prev[i];
+            } else {
+                memmove(out, in, line_bytes);
+            }
+            break;
+        case 3: // Average
+            if (prev) {
+                for (i = 0; i < bytewidth && i < line_bytes; i++) out[i] = in[i] + (prev[i] >> 1);
+                for (; i < line_bytes; i++) out[i] = in[i] + ((out[i - bytewidth] + prev[i]) >> 1);
+            } else {
+                for (i = 0; i < bytewidth && i < line_bytes; i++) out[i] = in[i];
+                for (; i < line_bytes; i++) out[i] = in[i] + (out[i - bytewidth] >> 1);
+            }
+            break;
+        case 4: // Paeth
+            if (prev) {
+                for (i = 0; i < bytewidth && i < line_bytes; i++) out[i] = in[i] + prev[i];
+                for (; i < line_bytes; i++)
+                    out[i] = in[i] + paeth(out[i - bytewidth], prev[i], prev[i - bytewidth]);
+            } else {
+                // With no previous line Paeth degenerates to Sub
+                for (i = 0; i < bytewidth && i < line_bytes; i++) out[i] = in[i];
+                for (; i < line_bytes; i++) out[i] = in[i] + out[i - bytewidth];
+            }
+            break;
+        default:
+            return false;
         }
+        prev = out;
     }
-    frames.clear();
-    width = 0;
-    height = 0;
+    return true;
 }
 
-bool APNGDecoder::Load(const char* path) {
-    Free();
-
-    std::vector<unsigned char> file_data;
-    unsigned error = lodepng::load_file(file_data, path);
-    if (error) {
-        BLOG(LOG_WARNING, "Failed to load file %s: %s", path, lodepng_error_text(error));
-        return false;
-    }
-
-    if (!ParseChunks(file_data)) {
-        // Fallback: Try loading as standard static PNG
-        BLOG(LOG_INFO, "Not an APNG, loading as static PNG: %s", path);
-        
-        std::vector<unsigned char> image;
-        unsigned w, h;
-        error = lodepng::decode(image, w, h, file_data);
-        if (error) return false;
-
-        width = w;
-        height = h;
-
-        APNGFrame frame;
-        frame.delay_ms = 1000;
-        
-        obs_enter_graphics();
-        const uint8_t* data_ptr = image.data();
-        frame.texture = gs_texture_create(w, h, GS_RGBA, 1, &data_ptr, GS_DYNAMIC);
-        obs_leave_graphics();
-        
-        if (frame.texture) {
-             gs_texture_set_image(frame.texture, image.data(), w * 4, false); // safety
-             frames.push_back(frame);
-             return true;
-        }
-        return false;
+// Converts packed rows of `mode` pixels to RGBA8. Rows of sub-byte formats
+// are padded to whole bytes, so those are converted one row at a time.
+static bool convert_rows(unsigned char* out, const unsigned char* in, const LodePNGColorMode& mode,
+                         unsigned w, unsigned h) {
+    LodePNGColorMode rgba;
+    lodepng_color_mode_init(&rgba);
+
+    unsigned bpp = lodepng_get_bpp(&mode);
+    if ((w * bpp) % 8 == 0)
+        return lodepng_convert(out, in, &rgba, &mode, w, h) == 0;
+
+    size_t line_bytes = ((size_t)w * bpp + 7) / 8;
+    for (unsigned y = 0; y < h; y++) {
+        if (lodepng_convert(out + (size_t)y * w * 4, in + y * line_bytes, &rgba, &mode, w, 1))
+            return false;
     }
+    return true;
+}
 
-    return !frames.empty();
+bool APNGCompositor::Parse(std::vector<unsigned char>&& data) {
+    file = std::move(data);
+    return Parse(file.data(), file.size());
 }
 
-bool APNGDecoder::ParseChunks(const std::vector<unsigned char>& source) {
-    if (source.size() < 29) return false; // Too small
-    
+bool APNGCompositor::Parse(const unsigned char* source, size_t size) {
+    if (size < 33) return false; // Signature + IHDR
+
     // Check Signature
     if (source[0] != 137 || source[1] != 80 || source[2] != 78) return false;
 
     // Read IHDR
     width = read_u32(&source[16]);
     height = read_u32(&source[20]);
+    if (width == 0 || height == 0 || width > 16384 || height > 16384) return false;
+
+    header.color.bitdepth = source[24];
+    header.color.colortype = (LodePNGColorType)source[25];
+    header.interlaced = source[28] == 1;
+    if (!png_color_valid(header.color.colortype, header.color.bitdepth)) return false;
 
-    std::vector<APNGFrameInfo> frame_infos;
+    infos.clear();
+    delays.clear();
     APNGFrameInfo current_info;
-    bool is_apng = false;
-    uint32_t first_frame_seq = 0;
 
-    std::vector<unsigned char> common_chunks;
+    // The default image of a file whose first frame has no fcTL is not
+    // part of the animation
+    auto store_frame = [this](APNGFrameInfo&& info) {
+        if (info.width == 0 || info.height == 0) return;
+
+        float num = (float)info.delay_num;
+        float den = (float)info.delay_den;
+        if (den == 0) den = 100.0f;
+        uint32_t delay_ms = (uint32_t)((num / den) * 1000.0f);
+        if (delay_ms == 0) delay_ms = 100; // Default min delay
+
+        delays.push_back(delay_ms);
+        infos.push_back(std::move(info));
+    };
+    bool is_apng = false;
 
     size_t pos = 8;
-    // Iterate chunks
-    while (pos < source.size()) {
-        if (pos + 8 > source.size()) break;
+    // Iterate chunks. Frame data is only referenced here and decoded below
+    // straight from the file buffer, without rebuilding PNG files per frame.
+    while (pos < size) {
+        if (pos + 8 > size) break;
         uint32_t len = read_u32(&source[pos]);
-        
+        if (pos + 12 + (size_t)len > size) break; // Truncated chunk
+
         const unsigned char* chunk_data = &source[pos + 8];
         uint32_t type = read_u32(&source[pos + 4]);
 
@@ -113,18 +175,17 @@ bool APNGDecoder::ParseChunks(const std::vector<unsigned char>& source) {
         type_str[4] = '\0';
         BLOG(LOG_DEBUG, "Chunk: %s, Len: %u", type_str, len);
 
-        if (type == 0x6163544C) { // acTL
+        if (type == 0x6163544C && len >= 8) { // acTL
             is_apng = true;
             num_plays = read_u32(chunk_data + 4);
-            BLOG(LOG_INFO, "Found acTL (APNG)! NumPlays: %u", num_plays);
+            BLOG(LOG_DEBUG, "Found acTL (APNG)! NumPlays: %u", num_plays);
         }
-        else if (type == 0x6663544C) { // fcTL
+        else if (type == 0x6663544C && len >= 26) { // fcTL
             // Finish previous frame info if valid
-            if (!current_info.compressed_data.empty()) {
-                frame_infos.push_back(current_info);
-                current_info = APNGFrameInfo();
-                current_info.compressed_data.clear();
+            if (current_info.data_size > 0) {
+                store_frame(std::move(current_info));
             }
+            current_info = APNGFrameInfo();
 
             current_info.seq = read_u32(chunk_data);
             current_info.width = read_u32(chunk_data + 4);
@@ -135,208 +196,234 @@ bool APNGDecoder::ParseChunks(const std::vector<unsigned char>& source) {
             current_info.delay_den = read_u16(chunk_data + 22);
             current_info.dispose_op = chunk_data[24];
             current_info.blend_op = chunk_data[25];
-            
-            BLOG(LOG_DEBUG, "fcTL Frame: %ux%u, Pos(%u,%u), Delay(%u/%u), Seq:%u", 
-                current_info.width, current_info.height, 
-                current_info.x_offset, current_info.y_offset, 
+
+            // A frame must lie inside the canvas (64-bit sums, no overflow)
+            if (current_info.width == 0 || current_info.height == 0 ||
+                (uint64_t)current_info.x_offset + current_info.width > width ||
+                (uint64_t)current_info.y_offset + current_info.height > height) {
+                BLOG(LOG_WARNING, "fcTL frame %ux%u at (%u,%u) outside the %ux%u canvas",
+                     current_info.width, current_info.height, current_info.x_offset,
+                     current_info.y_offset, width, height);
+                return false;
+            }
+
+            BLOG(LOG_DEBUG, "fcTL Frame: %ux%u, Pos(%u,%u), Delay(%u/%u), Seq:%u",
+                current_info.width, current_info.height,
+                current_info.x_offset, current_info.y_offset,
                 current_info.delay_num, current_info.delay_den, current_info.seq);
         }
         else if (type == 0x66644154) { // fdAT
-            if (is_apng) {
-                 // Sequence (4 bytes) + Data
-                 if (len > 4) {
-                     current_info.compressed_data.insert(current_info.compressed_data.end(), chunk_data + 4, chunk_data + len);
-                 }
+            // Sequence (4 bytes) + Data
+            if (is_apng && len > 4) {
+                current_info.data_spans.emplace_back(chunk_data + 4, len - 4);
+                current_info.data_size += len - 4;
             }
         }
         else if (type == 0x49444154) { // IDAT
-             current_info.compressed_data.insert(current_info.compressed_data.end(), chunk_data, chunk_data + len);
+            current_info.data_spans.emplace_back(chunk_data, len);
+            current_info.data_size += len;
         }
-        else if (type == 0x49454E44) { // IEND
-             if (!current_info.compressed_data.empty()) {
-                frame_infos.push_back(current_info);
-             }
-             break;
+        else if (type == 0x504C5445) { // PLTE
+            for (uint32_t i = 0; i + 3 <= len; i += 3) {
+                lodepng_palette_add(&header.color, chunk_data[i], chunk_data[i + 1], chunk_data[i + 2], 255);
+            }
         }
-        else if (type != 0x49484452) { // Not IHDR (handled manually), copy other chunks (PLTE, tRNS, etc.)
-             // Append entire chunk (Length + Type + Data + CRC)
-             common_chunks.insert(common_chunks.end(), &source[pos], &source[pos] + 8 + len + 4);
+        else if (type == 0x74524E53) { // tRNS
+            if (header.color.colortype == LCT_PALETTE) {
+                for (uint32_t i = 0; i < len && i < header.color.palettesize; i++)
+                    header.color.palette[4 * i + 3] = chunk_data[i];
+            } else if (header.color.colortype == LCT_GREY && len >= 2) {
+                header.color.key_defined = 1;
+                header.color.key_r = header.color.key_g = header.color.key_b = read_u16(chunk_data);
+            } else if (header.color.colortype == LCT_RGB && len >= 6) {
+                header.color.key_defined = 1;
+                header.color.key_r = read_u16(chunk_data);
+                header.color.key_g = read_u16(chunk_data + 2);
+                header.color.key_b = read_u16(chunk_data + 4);
+            }
+        }
+        else if (type == 0x49454E44) { // IEND
+            break;
         }
 
         pos += 8 + len + 4; // Length + Type + Data + CRC
     }
-    
-    if (!is_apng) return false;
-
-    // Now decode all collected frames
-    std::vector<unsigned char> canvas(width * height * 4, 0);       // Current full canvas
-    
-    total_duration_ms = 0;
-
-    obs_enter_graphics();
-
-    for (const auto& info : frame_infos) {
-        // Construct PNG
-        std::vector<unsigned char> png_data;
-        // Signature
-        const unsigned char sig[] = {137, 80, 78, 71, 13, 10, 26, 10};
-        png_data.insert(png_data.end(), sig, sig + 8);
-        
-        // IHDR
-        if (source.size() >= 33) {
-            std::vector<unsigned char> ihdr_body(13);
-            memcpy(ihdr_body.data(), &source[16], 13); // Copy IHDR body from original
-            
-            // Set W, H for this frame
-            set_u32_be(ihdr_body.data() + 0, info.width);
-            set_u32_be(ihdr_body.data() + 4, info.height);
-            
-            // Create chunk
-            unsigned char header[8];
-            set_u32_be(header, 13);
-            header[4] = 'I'; header[5] = 'H'; header[6] = 'D'; header[7] = 'R';
-            png_data.insert(png_data.end(), header, header + 8);
-            png_data.insert(png_data.end(), ihdr_body.begin(), ihdr_body.end());
-            
-            // CRC
-            std::vector<unsigned char> check_buf;
-            check_buf.push_back('I'); check_buf.push_back('H'); check_buf.push_back('D'); check_buf.push_back('R');
-            check_buf.insert(check_buf.end(), ihdr_body.begin(), ihdr_body.end());
-            unsigned crc = lodepng_crc32(check_buf.data(), check_buf.size());
-            
-            unsigned char crc_b[4]; set_u32_be(crc_b, crc);
-            png_data.insert(png_data.end(), crc_b, crc_b + 4);
-        }
+    if (current_info.data_size > 0) {
+        store_frame(std::move(current_info));
+    }
 
-        // Insert Common Chunks (PLTE, tRNS, gAMA...)
-        png_data.insert(png_data.end(), common_chunks.begin(), common_chunks.end());
-        
-        // IDAT (Joined data)
-        if (!info.compressed_data.empty()) {
-             unsigned char header[8];
-             set_u32_be(header, (uint32_t)info.compressed_data.size());
-             header[4] = 'I'; header[5] = 'D'; header[6] = 'A'; header[7] = 'T';
-             png_data.insert(png_data.end(), header, header + 8);
-             png_data.insert(png_data.end(), info.compressed_data.begin(), info.compressed_data.end());
-             
-             // CRC
-             std::vector<unsigned char> check_buf;
-             check_buf.push_back('I'); check_buf.push_back('D'); check_buf.push_back('A'); check_buf.push_back('T');
-             check_buf.insert(check_buf.end(), info.compressed_data.begin(), info.compressed_data.end());
-             unsigned crc = lodepng_crc32(check_buf.data(), check_buf.size());
-
-             unsigned char crc_b[4]; set_u32_be(crc_b, crc);
-             png_data.insert(png_data.end(), crc_b, crc_b + 4);
-        }
+    if (!is_apng || infos.empty()) return false;
 
-        // IEND
-        const unsigned char iend[] = {0,0,0,0, 'I','E','N','D', 174,66,96,130};
-        png_data.insert(png_data.end(), iend, iend + 12);
-
-        // Decode this frame
-        std::vector<unsigned char> frame_raw;
-        unsigned fw, fh;
-        unsigned error = lodepng::decode(frame_raw, fw, fh, png_data);
-        
-        if (error) {
-             BLOG(LOG_WARNING, "LodePNG Decode Error: %u %s", error, lodepng_error_text(error));
-        }
+    canvas.assign((size_t)width * height * 4, 0);
+    next_frame = 0;
+    return true;
+}
 
-        if (!error && fw == info.width && fh == info.height) {
-            
-            // 1. Snapshot for DISPOSE_PREVIOUS
-            std::vector<unsigned char> before_draw;
-            if (info.dispose_op == 2) { // APNG_DISPOSE_OP_PREVIOUS
-                before_draw = canvas;
-            }
+bool APNGCompositor::Next(std::vector<uint8_t>& out) {
+    if (infos.empty()) return false;
 
-            // 2. Blend
-            for (size_t y = 0; y < fh; ++y) {
-                for (size_t x = 0; x < fw; ++x) {
-                    size_t c_x = info.x_offset + x;
-                    size_t c_y = info.y_offset + y;
-                    if (c_x >= width || c_y >= height) continue;
-
-                    size_t src_idx = (y * fw + x) * 4;
-                    size_t dst_idx = (c_y * width + c_x) * 4;
-
-                    unsigned char r = frame_raw[src_idx + 0];
-                    unsigned char g = frame_raw[src_idx + 1];
-                    unsigned char b = frame_raw[src_idx + 2];
-                    unsigned char a = frame_raw[src_idx + 3];
-
-                    if (info.blend_op == 0) { // APNG_BLEND_OP_SOURCE
-                        canvas[dst_idx + 0] = r;
-                        canvas[dst_idx + 1] = g;
-                        canvas[dst_idx + 2] = b;
-                        canvas[dst_idx + 3] = a;
-                    } else { // APNG_BLEND_OP_OVER
-                         float src_a = a / 255.0f;
-                         float dst_a = canvas[dst_idx + 3] / 255.0f;
-                         float out_a = src_a + dst_a * (1.0f - src_a);
-
-                         if (out_a > 0.0f) {
-                             canvas[dst_idx + 0] = (unsigned char)((r * src_a + canvas[dst_idx + 0] * dst_a * (1 - src_a)) / out_a);
-                             canvas[dst_idx + 1] = (unsigned char)((g * src_a + canvas[dst_idx + 1] * dst_a * (1 - src_a)) / out_a);
-                             canvas[dst_idx + 2] = (unsigned char)((b * src_a + canvas[dst_idx + 2] * dst_a * (1 - src_a)) / out_a);
-                             canvas[dst_idx + 3] = (unsigned char)(out_a * 255.0f);
-                         } else {
-                             canvas[dst_idx + 3] = 0;
-                         }
-                    }
-                }
-            }
+    // Every loop starts from a transparent canvas
+    if (next_frame == 0)
+        std::fill(canvas.begin(), canvas.end(), 0);
 
-            // 3. Create Texture
-            APNGFrame frame;
-            float num = (float)info.delay_num;
-            float den = (float)info.delay_den;
-            if (den == 0) den = 100.0f;
-            frame.delay_ms = (uint32_t)((num / den) * 1000.0f);
-            if (frame.delay_ms == 0) frame.delay_ms = 100; // Default min delay
-
-            const uint8_t* data_ptr = canvas.data();
-            frame.texture = gs_texture_create(width, height, GS_RGBA, 1, &data_ptr, GS_DYNAMIC);
-            frames.push_back(frame);
-            total_duration_ms += frame.delay_ms;
-
-            // 4. Dispose
-            if (info.dispose_op == 1) { // APNG_DISPOSE_OP_BACKGROUND
-                 for (size_t y = 0; y < fh; ++y) {
-                    for (size_t x = 0; x < fw; ++x) {
-                        size_t c_x = info.x_offset + x;
-                        size_t c_y = info.y_offset + y;
-                        if (c_x >= width || c_y >= height) continue;
-                        size_t dst_idx = (c_y * width + c_x) * 4;
-                        memset(&canvas[dst_idx], 0, 4);
-                    }
-                 }
-            } else if (info.dispose_op == 2) { // APNG_DISPOSE_OP_PREVIOUS
-                canvas = before_draw;
-            }
+    const APNGFrameInfo& info = infos[next_frame];
+    next_frame = (next_frame + 1) % infos.size();
+
+    // A frame that fails to decode shows the canvas as it was
+    if (!DecodeFrame(info, frame_raw)) {
+        BLOG(LOG_WARNING, "Failed to decode frame (seq %u)", info.seq);
+        out.assign(canvas.begin(), canvas.end());
+        return true;
+    }
+
+    // 1. Snapshot for DISPOSE_PREVIOUS
+    if (info.dispose_op == 2) { // APNG_DISPOSE_OP_PREVIOUS
+        before_draw = canvas;
+    }
+
+    // 2. Blend
+    composite_rect(canvas.data(), width, height, frame_raw.data(), info.width, info.height,
+                   info.x_offset, info.y_offset,
+                   info.blend_op == 0 ? BlendOp::SOURCE : BlendOp::OVER);
+
+    // 3. Hand out a copy of the canvas
+    out.assign(canvas.begin(), canvas.end());
+
+    // 4. Dispose
+    if (info.dispose_op == 1) { // APNG_DISPOSE_OP_BACKGROUND
+        composite_rect(canvas.data(), width, height, nullptr, info.width, info.height,
+                       info.x_offset, info.y_offset, BlendOp::CLEAR);
+    } else if (info.dispose_op == 2) { // APNG_DISPOSE_OP_PREVIOUS
+        canvas.swap(before_draw);
+    }
+    return true;
+}
+
+// Inflates one frame's image data and turns it into RGBA8 pixels in `out`:
+// zlib stream -> unfilter (per Adam7 pass if interlaced) -> color convert.
+// A frame stored in a single chunk is inflated in place from the file
+// buffer; split chunks are joined first, since the zlib stream spans them.
+bool APNGCompositor::DecodeFrame(const APNGFrameInfo& info, std::vector<unsigned char>& out) {
+    const unsigned char* zdata = info.data_spans[0].first;
+    std::vector<unsigned char> joined;
+    if (info.data_spans.size() > 1) {
+        joined.reserve(info.data_size);
+        for (const auto& span : info.data_spans)
+            joined.insert(joined.end(), span.first, span.first + span.second);
+        zdata = joined.data();
+    }
+
+    const unsigned w = info.width, h = info.height;
+    const unsigned bpp = lodepng_get_bpp(&header.color);
+
+    unsigned char* raw = nullptr;
+    size_t raw_size = 0;
+    unsigned error = png_inflate(&raw, &raw_size, zdata, info.data_size, png_raw_size(w, h, bpp, header.interlaced));
+    std::unique_ptr<unsigned char, void (*)(void*)> raw_owner(raw, free);
+    if (error) {
+        BLOG(LOG_WARNING, "Inflate Error: %u %s", error, lodepng_error_text(error));
+        return false;
+    }
+
+    // Check the size before allocating anything for the frame
+    if (raw_size < png_raw_size(w, h, bpp, header.interlaced)) return false;
+    out.resize((size_t)w * h * 4);
+
+    if (!header.interlaced) {
+        if (!unfilter(raw, w, h, bpp)) return false;
+        return convert_rows(out.data(), raw, header.color, w, h);
+    }
+
+    // Adam7: seven reduced images, each filtered on its own
+    static const unsigned ix[7] = {0, 4, 0, 2, 0, 1, 0};
+    static const unsigned iy[7] = {0, 0, 4, 0, 2, 0, 1};
+    static const unsigned dx[7] = {8, 8, 4, 4, 2, 2, 1};
+    static const unsigned dy[7] = {8, 8, 8, 4, 4, 2, 2};
+
+    std::vector<unsigned char> row;
+    size_t offset = 0;
+    for (int p = 0; p < 7; p++) {
+        unsigned pw = (w + dx[p] - ix[p] - 1) / dx[p];
+        unsigned ph = (h + dy[p] - iy[p] - 1) / dy[p];
+        if (pw == 0 || ph == 0) continue;
+
+        size_t line_bytes = ((size_t)pw * bpp + 7) / 8;
+        size_t pass_size = ph * (line_bytes + 1);
+        if (offset + pass_size > raw_size) return false;
+
+        unsigned char* pass = raw + offset;
+        if (!unfilter(pass, pw, ph, bpp)) return false;
+
+        row.resize((size_t)pw * 4);
+        for (unsigned y = 0; y < ph; y++) {
+            if (!convert_rows(row.data(), pass + y * line_bytes, header.color, pw, 1)) return false;
+            unsigned char* dst = out.data() + ((size_t)(iy[p] + y * dy[p]) * w + ix[p]) * 4;
+            for (unsigned x = 0; x < pw; x++)
+                memcpy(dst + (size_t)x * dx[p] * 4, &row[(size_t)x * 4], 4);
         }
+        offset += pass_size;
     }
-    
-    obs_leave_graphics();
     return true;
 }
 
-void APNGDecoder::DecodeFrame(const APNGFrameInfo& info, std::vector<unsigned char>& canvas, std::vector<unsigned char>& prev_canvas) {
-    // Unused helper, logic moved inline
+APNGDecoder::APNGDecoder() {}
+
+APNGDecoder::~APNGDecoder() {
+    Free();
 }
 
-gs_texture_t* APNGDecoder::GetTextureForTime(uint64_t time_ms) {
-    if (frames.empty()) return nullptr;
-    if (frames.size() == 1) return frames[0].texture;
-    
-    uint64_t t = time_ms % total_duration_ms;
-    uint64_t current_t = 0;
-    
-    for (const auto& f : frames) {
-        if (t < current_t + f.delay_ms) {
-            return f.texture;
+void APNGDecoder::Free() {
+    frames.Clear();
+    width = 0;
+    height = 0;
+}
+
+bool APNGDecoder::Load(const unsigned char* data, size_t size, FrameStorage storage, uint32_t max_dim) {
+    Free();
+
+    if (png_is_animated(data, size)) {
+        std::unique_ptr<APNGCompositor> compositor(new APNGCompositor());
+
+        // A streamed animation decodes from its own copy of the file later
+        bool parsed = storage == FrameStorage::STREAMING
+                          ? compositor->Parse(std::vector<unsigned char>(data, data + size))
+                          : compositor->Parse(data, size);
+
+        if (parsed) {
+            width = compositor->GetWidth();
+            height = compositor->GetHeight();
+            num_plays = compositor->GetNumPlays();
+            const std::vector<uint32_t> delays = compositor->GetDelays();
+
+            if (frames.Begin(width, height, delays.size(), storage, max_dim)) {
+                frames.Stream(std::move(compositor), delays);
+                return true;
+            }
+
+            std::vector<unsigned char> canvas;
+            for (uint32_t delay_ms : delays) {
+                compositor->Next(canvas);
+                frames.Add(canvas.data(), delay_ms);
+            }
+            return frames.Finish();
         }
-        current_t += f.delay_ms;
     }
-    return frames.back().texture;
+
+    // Static PNGs skip the chunk walk and are decoded exactly once; the
+    // pixels are kept as a single frame instead of being decoded again
+    lodepng::State state;
+    unsigned w, h;
+    if (lodepng_inspect(&w, &h, &state, data, size)) return false;
+    size_t raw_size = png_raw_size(w, h, lodepng_get_bpp(&state.info_png.color), state.info_png.interlace_method == 1);
+    png_inflate_setup(&state.decoder.zlibsettings, &raw_size);
+
+    std::vector<unsigned char> image;
+    unsigned error = lodepng::decode(image, w, h, state, data, size);
+    if (error) return false;
+
+    width = w;
+    height = h;
+    frames.Begin(width, height, 1, FrameStorage::RESIDENT, max_dim);
+    frames.Add(image.data(), 1000);
+    return frames.Finish();
 }
@@ -1,14 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <string>
+#include <utility>
 #include <graphics/graphics.h>
 #include "lodepng.h"
-
-struct APNGFrame {
-    gs_texture_t* texture = nullptr; // The final full-frame texture to render
-    uint32_t delay_ms = 100;         // Delay before next frame
-};
+#include "frame-store.h"
 
 // Internal structure to hold frame control data
 struct APNGFrameInfo {
@@ -18,8 +16,59 @@ struct APNGFrameInfo {
     uint16_t delay_num = 0, delay_den = 0;
     uint8_t dispose_op = 0;
     uint8_t blend_op = 0;
-    
-    std::vector<unsigned char> compressed_data;
+
+    // Payloads of the frame's IDAT/fdAT chunks, pointing into the file buffer
+    std::vector<std::pair<const unsigned char*, size_t>> data_spans;
+    size_t data_size = 0;
+};
+
+// Pixel format shared by every frame, from IHDR, PLTE and tRNS
+struct APNGHeader {
+    LodePNGColorMode color;
+    bool interlaced = false;
+
+    APNGHeader() { lodepng_color_mode_init(&color); }
+    ~APNGHeader() { lodepng_color_mode_cleanup(&color); }
+    APNGHeader(const APNGHeader&) = delete;
+    APNGHeader& operator=(const APNGHeader&) = delete;
+};
+
+// Walks the chunks of an APNG once, then composites its frames in order.
+// Used to decode every frame up front and, in streaming mode, as the
+// FrameProducer that decodes them on demand.
+class APNGCompositor : public FrameProducer {
+public:
+    // Parses `data`, which must outlive the compositor
+    bool Parse(const unsigned char* data, size_t size);
+    // Takes a copy of the file, so frames can be decoded at any time later
+    bool Parse(std::vector<unsigned char>&& data);
+
+    bool Next(std::vector<uint8_t>& out) override;
+    void Rewind() override { next_frame = 0; }
+    size_t GetMemorySize() const override { return file.size(); }
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    uint32_t GetNumPlays() const { return num_plays; }
+    size_t GetFrameCount() const { return infos.size(); }
+    const std::vector<uint32_t>& GetDelays() const { return delays; }
+
+private:
+    bool DecodeFrame(const APNGFrameInfo& info, std::vector<unsigned char>& out);
+
+    std::vector<unsigned char> file; // Owned file data (streaming only)
+    APNGHeader header;
+    std::vector<APNGFrameInfo> infos;
+    std::vector<uint32_t> delays;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t num_plays = 0;
+
+    // Compositing state between Next() calls
+    std::vector<unsigned char> canvas;
+    std::vector<unsigned char> frame_raw;
+    std::vector<unsigned char> before_draw;
+    size_t next_frame = 0;
 };
 
 class APNGDecoder {
@@ -27,22 +76,35 @@ public:
     APNGDecoder();
     ~APNGDecoder();
 
-    bool Load(const char* path);
+    // Decodes an in-memory PNG/APNG file. CPU only, so it is safe to call
+    // off the graphics thread. `storage` picks where the frames of long
+    // animations live (see FrameStorage); only STREAMING keeps a copy of
+    // the file, otherwise the buffer is not referenced afterwards. Images
+    // larger than `max_dim` (0 = no limit) are downscaled to fit before upload.
+    bool Load(const unsigned char* data, size_t size, FrameStorage storage = FrameStorage::RESIDENT,
+              uint32_t max_dim = 0);
+    // Creates textures for decoded frames. Caller must hold the graphics context.
+    bool Upload() { return frames.Upload(); }
     void Free();
 
-    gs_texture_t* GetTextureForTime(uint64_t time_ms);
-    
-    bool IsAnimated() const { return frames.size() > 1; }
-    uint32_t GetWidth() const { return width; }
+    // Playback, see FrameStore
+    void Tick(uint64_t time_ms) { frames.Tick(time_ms); }
+    void Render(uint64_t time_ms, DeltaCanvas& canvas) const { frames.Render(time_ms, canvas); }
+    gs_texture_t* GetTexture(const DeltaCanvas& canvas) const { return frames.GetTexture(canvas); }
+
+    bool IsAnimated() const { return GetFrameCount() > 1; }
+    bool IsStreaming() const { return frames.IsStreaming(); }
+    size_t GetFrameCount() const { return frames.GetFrameCount(); }
+    size_t GetRamSize() const { return frames.GetRamSize(); }
+    size_t GetVramSize() const { return frames.GetVramSize(); }
+    uint64_t GetDuration() const { return frames.GetDuration(); } // One loop, in ms
+    uint32_t GetNumPlays() const { return num_plays; }               // 0 = forever
+    uint32_t GetWidth() const { return width; }   // Size of the image in the file
     uint32_t GetHeight() const { return height; }
 
 private:
-    std::vector<APNGFrame> frames;
+    FrameStore frames;
     uint32_t width = 0;
     uint32_t height = 0;
     uint32_t num_plays = 0;
-    uint64_t total_duration_ms = 0;
-
-    bool ParseChunks(const std::vector<unsigned char>& source);
-    void DecodeFrame(const APNGFrameInfo& info, std::vector<unsigned char>& canvas, std::vector<unsigned char>& prev_canvas);
 };
@@ -0,0 +1,255 @@
+#include "asset-cache.h"
+#include <util/platform.h>
+#include <string.h>
+
+#define BLOG(level, format, ...) blog(level, "[Asset-Cache] " format, ##__VA_ARGS__)
+
+size_t FloodAsset::GetRamSize() const {
+    if (type == CUSTOM_WEBP && webp_decoder) return webp_decoder->GetRamSize();
+    if (type == CUSTOM_APNG && apng_decoder) return apng_decoder->GetRamSize();
+    if (type == CUSTOM_GIF && gif_decoder) return gif_decoder->GetRamSize();
+    // gs_image_file keeps its decoded pixels until freed
+    return (size_t)obs_image.cx * obs_image.cy * 4 * GetFrameCount();
+}
+
+size_t FloodAsset::GetVramSize() const {
+    if (type == CUSTOM_WEBP && webp_decoder) return webp_decoder->GetVramSize();
+    if (type == CUSTOM_APNG && apng_decoder) return apng_decoder->GetVramSize();
+    if (type == CUSTOM_GIF && gif_decoder) return gif_decoder->GetVramSize();
+    return (size_t)obs_image.cx * obs_image.cy * 4 * GetFrameCount();
+}
+
+size_t FloodAsset::GetFrameCount() const {
+    if (type == CUSTOM_WEBP && webp_decoder) return webp_decoder->GetFrameCount();
+    if (type == CUSTOM_APNG && apng_decoder) return apng_decoder->GetFrameCount();
+    if (type == CUSTOM_GIF && gif_decoder) return gif_decoder->GetFrameCount();
+    if (obs_image.is_animated_gif) return obs_image.gif.frame_count;
+    return obs_image.cx ? 1 : 0;
+}
+
+AssetCache& AssetCache::Get() {
+    static AssetCache cache;
+    return cache;
+}
+
+// Reads a whole image file into memory with a single sequential read. The
+// same buffer is hashed and then decoded, so each file is opened only once
+// (gs_image_file formats excepted; it reads by path).
+static bool read_file(const char *path, std::vector<uint8_t> &out)
+{
+    FILE *f = os_fopen(path, "rb");
+    if (!f) return false;
+
+    int64_t size = os_fgetsize(f);
+    bool ok = size > 0;
+    if (ok) {
+        out.resize((size_t)size);
+        ok = fread(out.data(), 1, out.size(), f) == out.size();
+    }
+    fclose(f);
+    if (!ok) out.clear();
+    return ok;
+}
+
+// 64-bit FNV-1a over 8-byte words. Not cryptographic; together with the
+// file size it only has to tell apart the handful of images a user loads.
+static FloodContentKey hash_content(const std::vector<uint8_t> &file)
+{
+    FloodContentKey content;
+    if (file.empty()) return content;
+
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + 8 <= file.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, &file[i], 8);
+        h = (h ^ word) * prime;
+        h ^= h >> 29;
+    }
+    for (; i < file.size(); i++) {
+        h = (h ^ file[i]) * prime;
+    }
+
+    content.hash = h;
+    content.size = (int64_t)file.size();
+    return content;
+}
+
+// Drops entries whose last user went away. Caller holds the mutex.
+template<typename Key>
+static void sweep_expired(std::map<Key, AssetCache::Slot> &slots)
+{
+    for (auto it = slots.begin(); it != slots.end();) {
+        if (!it->second.decoding && it->second.asset.expired())
+            it = slots.erase(it);
+        else
+            ++it;
+    }
+}
+
+// Waits while `key` is being decoded elsewhere, then returns its asset if
+// one is still alive. Caller holds `lock`.
+template<typename Key>
+static std::shared_ptr<FloodAsset> wait_for_slot(std::unique_lock<std::mutex> &lock,
+    std::condition_variable &decoded, std::map<Key, AssetCache::Slot> &slots, const Key &key)
+{
+    for (;;) {
+        auto it = slots.find(key);
+        if (it == slots.end()) return nullptr;
+
+        // Another thread is decoding this file right now
+        if (it->second.decoding) {
+            decoded.wait(lock);
+            continue;
+        }
+        return it->second.asset.lock();
+    }
+}
+
+std::shared_ptr<FloodAsset> AssetCache::Acquire(const FloodFileKey& key, const DecodeFunc& decode,
+                                                bool* shared) {
+    if (shared) *shared = true;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::shared_ptr<FloodAsset> asset = wait_for_slot(lock, decoded, assets, key);
+        if (asset) {
+            BLOG(LOG_DEBUG, "Sharing decoded asset: %s", key.path.c_str());
+            TouchRetained(key);
+            return asset;
+        }
+
+        sweep_expired(assets);
+        sweep_expired(contents);
+        assets[key].decoding = true;
+    }
+
+    uint64_t start_ns = os_gettime_ns();
+    std::vector<uint8_t> file;
+    read_file(key.path.c_str(), file);
+    uint64_t read_ns = os_gettime_ns() - start_ns;
+    FloodContentKey content = hash_content(file);
+    content.max_dim = key.max_dim;
+    content.policy = key.policy;
+
+    // Same bytes under another path: reuse that decode and texture
+    if (content.IsValid()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::shared_ptr<FloodAsset> asset = wait_for_slot(lock, decoded, contents, content);
+        if (asset) {
+            assets[key] = Slot{asset, false};
+            lock.unlock();
+            decoded.notify_all();
+            BLOG(LOG_DEBUG, "Sharing identical content: %s", key.path.c_str());
+            return asset;
+        }
+        contents[content].decoding = true;
+    }
+
+    auto asset = std::make_shared<FloodAsset>();
+    start_ns = os_gettime_ns();
+    decode(asset.get(), file);
+    asset->stats.file_bytes = file.size();
+    asset->stats.read_ns = read_ns;
+    asset->stats.decode_ns = os_gettime_ns() - start_ns;
+    asset->stats.ram_bytes = asset->GetRamSize();
+    if (shared) *shared = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (asset->shareable) {
+            assets[key] = Slot{asset, false};
+            if (content.IsValid())
+                contents[content] = Slot{asset, false};
+        } else {
+            // Waiters find no entry and decode a private copy
+            assets.erase(key);
+            if (content.IsValid())
+                contents.erase(content);
+        }
+    }
+    decoded.notify_all();
+    return asset;
+}
+
+void AssetCache::Prewarm(const FloodFileKey& key, const DecodeFunc& decode) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (prewarm_full || prewarm_budget == 0) return;
+        for (const auto& r : retained) {
+            if (r.key == key) return;
+        }
+    }
+
+    std::shared_ptr<FloodAsset> asset = Acquire(key, decode);
+    if (!asset->shareable) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (prewarm_budget == 0) return;
+        for (const auto& r : retained) {
+            if (r.key == key) return; // Raced with another prewarm
+        }
+
+        // A library larger than the budget would otherwise keep evicting
+        // what it just prewarmed. Prewarmed assets are not uploaded, so
+        // everything they hold is in RAM.
+        size_t bytes = asset->GetRamSize();
+        if (retained_bytes + bytes > prewarm_budget) {
+            if (!prewarm_full)
+                BLOG(LOG_INFO, "Prewarm budget full (%.1f MB), not preloading further avatars",
+                     prewarm_budget / (1024.0 * 1024.0));
+            prewarm_full = true;
+            return; // `asset` is released after unlocking
+        }
+
+        Retained r;
+        r.key = key;
+        r.asset = asset;
+        r.bytes = bytes;
+        retained_bytes += r.bytes;
+        retained.push_front(std::move(r));
+    }
+    BLOG(LOG_DEBUG, "Prewarmed: %s", key.path.c_str());
+}
+
+void AssetCache::UpdateRetained(const FloodAsset* asset) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& r : retained) {
+        if (r.asset.get() != asset) continue;
+        retained_bytes -= r.bytes;
+        r.bytes = asset->GetRamSize() + asset->GetVramSize();
+        retained_bytes += r.bytes;
+        return;
+    }
+}
+
+void AssetCache::SetPrewarmBudget(size_t bytes) {
+    std::list<Retained> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        prewarm_budget = bytes;
+        prewarm_full = false;
+        EvictRetained(evicted);
+    }
+}
+
+// Moves a prewarmed asset to the front of the LRU list. Caller holds the mutex.
+void AssetCache::TouchRetained(const FloodFileKey& key) {
+    for (auto it = retained.begin(); it != retained.end(); ++it) {
+        if (it->key == key) {
+            retained.splice(retained.begin(), retained, it);
+            return;
+        }
+    }
+}
+
+// Drops least recently used assets until the list fits the budget. Only
+// runs when the budget is set, since Prewarm() stops instead of evicting.
+// Caller holds the mutex; the evicted list is released after unlocking.
+void AssetCache::EvictRetained(std::list<Retained>& evicted) {
+    while (!retained.empty() && retained_bytes > prewarm_budget) {
+        retained_bytes -= retained.back().bytes;
+        evicted.splice(evicted.begin(), retained, std::prev(retained.end()));
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/image-file.h>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "webp-decoder.h"
+#include "apng-decoder.h"
+#include "gif-decoder.h"
+
+// How an animation keeps its frames. RESIDENT decodes and uploads every
+// frame at load; COMPRESSED decodes them at load but keeps them
+// LZ4-compressed in RAM; STREAMING keeps only the file. The last two
+// decompress or decode frames during playback into a small texture ring
+// (long APNG/WebP/GIF animations).
+enum class FloodMemoryPolicy {
+    RESIDENT,
+    COMPRESSED,
+    STREAMING
+};
+
+// Identifies the file behind an image slot. Applying settings only
+// re-decodes slots whose key changed, and sources showing the same key
+// share one decoded asset.
+struct FloodFileKey {
+    std::string path;  // Absolute path, empty for an unset slot
+    int64_t size = -1; // -1 if the file could not be stat'ed
+    int64_t mtime = 0;
+    FloodMemoryPolicy policy = FloodMemoryPolicy::RESIDENT;
+    uint32_t max_dim = 0; // Texture size cap, 0 = full size
+
+    bool operator==(const FloodFileKey& other) const {
+        return size == other.size && mtime == other.mtime && policy == other.policy && max_dim == other.max_dim &&
+               path == other.path;
+    }
+    bool operator!=(const FloodFileKey& other) const { return !(*this == other); }
+    bool operator<(const FloodFileKey& other) const {
+        return std::tie(path, size, mtime, policy, max_dim) <
+               std::tie(other.path, other.size, other.mtime, other.policy, other.max_dim);
+    }
+};
+
+// Identifies file contents regardless of path, so slots that point at
+// byte-identical copies (a blink frame saved twice, talk_c == talk_a) share
+// one decode and one texture
+struct FloodContentKey {
+    uint64_t hash = 0;
+    int64_t size = -1; // -1 if the file could not be read
+    uint32_t max_dim = 0; // Same bytes capped to another size decode separately
+    FloodMemoryPolicy policy = FloodMemoryPolicy::RESIDENT; // Likewise for another frame storage
+
+    bool IsValid() const { return size > 0; }
+    bool operator<(const FloodContentKey& other) const {
+        return std::tie(size, hash, max_dim, policy) < std::tie(other.size, other.hash, other.max_dim, other.policy);
+    }
+};
+
+// Where the load time and memory of one asset went. Filled in by the cache
+// (read, decode) and by the upload on the graphics thread.
+struct FloodAssetStats {
+    const char* format = "none"; // Detected file format
+    size_t file_bytes = 0;       // Bytes read from disk
+    uint64_t read_ns = 0;
+    uint64_t decode_ns = 0;      // Wall time on the worker thread
+    size_t ram_bytes = 0;        // Decoded pixels until upload, then what playback keeps in RAM
+    uint64_t upload_ns = 0;      // Texture creation on the graphics thread
+    size_t vram_bytes = 0;
+};
+
+// Decoded image data for one file. Shared (refcounted) between every
+// source and slot showing the same file, so it is decoded and uploaded once.
+struct FloodAsset {
+    enum Type {
+        OBS_STANDARD, // Uses gs_image_file_t (JPEG, BMP, etc.)
+        CUSTOM_WEBP,  // Uses WebPDecoder
+        CUSTOM_APNG,  // Uses APNGDecoder (animated and static PNG)
+        CUSTOM_GIF    // Uses GIFDecoder
+    } type = OBS_STANDARD;
+
+    // Standard OBS loader
+    gs_image_file_t obs_image;
+
+    // Custom decoders
+    WebPDecoder* webp_decoder = nullptr;
+    APNGDecoder* apng_decoder = nullptr;
+    GIFDecoder* gif_decoder = nullptr;
+
+    FloodAssetStats stats;
+
+    bool uploaded = false;  // Textures created (graphics thread only)
+    bool shareable = true;  // False for state that is ticked per source (animated GIF, streaming)
+
+    // Size in the file when obs_image was downscaled, else 0
+    uint32_t full_cx = 0;
+    uint32_t full_cy = 0;
+
+    FloodAsset() {
+        gs_image_file_init(&obs_image, NULL);
+    }
+
+    ~FloodAsset() {
+        obs_enter_graphics();
+        delete webp_decoder;
+        delete apng_decoder;
+        delete gif_decoder;
+        gs_image_file_free(&obs_image);
+        obs_leave_graphics();
+    }
+
+    // Bytes held in RAM now (pixels waiting for upload, compressed frames,
+    // stream buffers), used for the prewarm budget
+    size_t GetRamSize() const;
+    // Bytes of textures once uploaded
+    size_t GetVramSize() const;
+    size_t GetFrameCount() const;
+
+    FloodAsset(const FloodAsset&) = delete;
+    FloodAsset& operator=(const FloodAsset&) = delete;
+};
+
+// Process-wide cache of decoded assets keyed by FloodFileKey. Assets in use
+// are tracked by weak reference and live as long as some source shows them.
+// Prewarmed assets are additionally kept alive in a list bounded by a memory
+// budget, so loading them later skips the decode. The list fills once;
+// least recently used entries are dropped only when the budget is lowered.
+class AssetCache {
+public:
+    // Decodes `file` (the bytes at key.path, empty if unreadable) into the asset
+    using DecodeFunc = std::function<void(FloodAsset*, const std::vector<uint8_t>& file)>;
+
+    // One cache entry: the live asset, or a decode in progress
+    struct Slot {
+        std::weak_ptr<FloodAsset> asset;
+        bool decoding = false;
+    };
+
+    static AssetCache& Get();
+
+    // Returns the shared asset for `key`, running `decode` if no source has
+    // it loaded yet. A file whose bytes match an asset already loaded under
+    // another path reuses that asset. Concurrent callers for the same key or
+    // content wait for the first decode instead of repeating it. Safe to
+    // call from worker threads. `shared` is set if no decode was needed.
+    std::shared_ptr<FloodAsset> Acquire(const FloodFileKey& key, const DecodeFunc& decode,
+                                        bool* shared = nullptr);
+
+    // Decodes `key` ahead of time and keeps it in the retained list. Once an
+    // asset no longer fits the budget it is dropped instead of evicting
+    // earlier ones, and later calls return without decoding until the budget
+    // is set again. Safe to call from worker threads.
+    void Prewarm(const FloodFileKey& key, const DecodeFunc& decode);
+
+    // Recounts a retained asset after its textures were created: the pixels
+    // handed to the GPU no longer count, its VRAM now does
+    void UpdateRetained(const FloodAsset* asset);
+
+    // Memory budget for prewarmed assets; 0 disables prewarming and releases
+    // everything retained so far
+    void SetPrewarmBudget(size_t bytes);
+
+private:
+    AssetCache() = default;
+
+    struct Retained {
+        FloodFileKey key;
+        std::shared_ptr<FloodAsset> asset;
+        size_t bytes = 0;
+    };
+
+    void TouchRetained(const FloodFileKey& key);
+    void EvictRetained(std::list<Retained>& evicted);
+
+    std::mutex mutex;
+    std::condition_variable decoded;
+    std::map<FloodFileKey, Slot> assets;
+    std::map<FloodContentKey, Slot> contents;
+
+    std::list<Retained> retained; // Most recently used first
+    size_t retained_bytes = 0;    // RAM before upload, RAM + VRAM after
+    size_t prewarm_budget = 0;
+    bool prewarm_full = false; // An asset did not fit; stop decoding more
+};
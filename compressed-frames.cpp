@@ -0,0 +1,54 @@
+#include "compressed-frames.h"
+#include <lz4.h>
+#include <string.h>
+
+CompressedFrames::CompressedFrames(uint32_t width, uint32_t height)
+    : width(width), height(height), current((size_t)width * height * 4, 0), diff(current.size()) {}
+
+// dst ^= src, a word at a time
+static void xor_bytes(uint8_t* dst, const uint8_t* src, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, dst + i, 8);
+        memcpy(&b, src + i, 8);
+        a ^= b;
+        memcpy(dst + i, &a, 8);
+    }
+    for (; i < size; i++)
+        dst[i] ^= src[i];
+}
+
+bool CompressedFrames::Add(const uint8_t* image) {
+    const size_t size = current.size();
+    if (!frames.empty() && memcmp(current.data(), image, size) == 0) return false;
+
+    // The first frame is XORed against a blank canvas, i.e. stored as is
+    memcpy(diff.data(), image, size);
+    xor_bytes(diff.data(), current.data(), size);
+
+    std::vector<char> block(LZ4_compressBound((int)size));
+    int block_size = LZ4_compress_default((const char*)diff.data(), block.data(), (int)size, (int)block.size());
+    block.resize(block_size > 0 ? block_size : 0);
+    block.shrink_to_fit();
+    compressed_bytes += block.size();
+    frames.push_back(std::move(block));
+
+    memcpy(current.data(), image, size);
+    return true;
+}
+
+bool CompressedFrames::Next(std::vector<uint8_t>& canvas) {
+    if (frames.empty()) return false;
+    const size_t size = current.size();
+    if (next_frame >= frames.size()) next_frame = 0;
+    if (next_frame == 0) memset(current.data(), 0, size);
+
+    const std::vector<char>& block = frames[next_frame++];
+    int out = LZ4_decompress_safe(block.data(), (char*)diff.data(), (int)block.size(), (int)size);
+    if (out != (int)size) return false;
+
+    xor_bytes(current.data(), diff.data(), size);
+    canvas.assign(current.begin(), current.end());
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "frame-stream.h"
+
+// Middle tier between fully resident and streamed animations: every frame
+// is decoded once at load and kept LZ4-compressed in system RAM, then
+// played through a FrameStream, which decompresses a few frames ahead into
+// its small texture ring. Replaying costs a memcpy-speed decompress instead
+// of a PNG/WebP decode, and VRAM stays at the ring.
+//
+// Each frame is stored as its XOR with the frame before it, so the pixels
+// that did not change (most of an avatar) compress to almost nothing.
+// Frames therefore come out strictly in order, as FrameProducer requires.
+class CompressedFrames : public FrameProducer {
+public:
+    CompressedFrames(uint32_t width, uint32_t height);
+
+    // Appends the next full RGBA canvas (width * height * 4 bytes, below
+    // LZ4's 2 GB limit like any texture). Returns
+    // false if it is identical to the previous frame; the caller then
+    // extends that frame's duration instead. Call before playback starts.
+    bool Add(const uint8_t* image);
+
+    bool Next(std::vector<uint8_t>& canvas) override;
+    void Rewind() override { next_frame = 0; }
+    size_t GetMemorySize() const override { return compressed_bytes + (size_t)width * height * 8; }
+
+    size_t GetFrameCount() const { return frames.size(); }
+    size_t GetCompressedSize() const { return compressed_bytes; }
+
+private:
+    uint32_t width;
+    uint32_t height;
+    std::vector<std::vector<char>> frames; // LZ4 blocks
+    size_t compressed_bytes = 0;
+
+    std::vector<uint8_t> current; // Last frame added, then last frame played
+    std::vector<uint8_t> diff;    // XOR scratch
+    size_t next_frame = 0;
+};
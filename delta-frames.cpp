@@ -0,0 +1,200 @@
+#include "delta-frames.h"
+#include <string.h>
+
+#define BLOG(level, format, ...) blog(level, "[Delta-Frames] " format, ##__VA_ARGS__)
+
+DeltaFrames::DeltaFrames(uint32_t width, uint32_t height) : width(width), height(height) {}
+
+DeltaFrames::~DeltaFrames() {
+    obs_enter_graphics();
+    for (auto& f : frames) {
+        if (f.texture && f.source == SIZE_MAX) gs_texture_destroy(f.texture);
+    }
+    obs_leave_graphics();
+}
+
+// FNV-1a over a rectangle's pixels and size
+static uint64_t hash_rect(const std::vector<uint8_t>& pixels, uint32_t w, uint32_t h) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint8_t b) {
+        hash ^= b;
+        hash *= 1099511628211ULL;
+    };
+    for (int i = 0; i < 4; i++) mix((uint8_t)(w >> (i * 8)));
+    for (int i = 0; i < 4; i++) mix((uint8_t)(h >> (i * 8)));
+    for (uint8_t b : pixels) mix(b);
+    return hash;
+}
+
+bool DeltaFrames::Add(const uint8_t* image) {
+    const size_t stride = (size_t)width * 4;
+    Frame frame;
+    frame.keyframe = frames.empty();
+
+    if (!frames.empty()) {
+        // Bounding box of the pixels that differ from the previous frame
+        uint32_t x0 = width, x1 = 0, y0 = height, y1 = 0;
+        for (uint32_t y = 0; y < height; y++) {
+            const uint8_t* a = previous.data() + y * stride;
+            const uint8_t* b = image + y * stride;
+            if (memcmp(a, b, stride) == 0) continue;
+
+            uint32_t left = 0, right = width - 1;
+            while (memcmp(a + left * 4, b + left * 4, 4) == 0) left++;
+            while (memcmp(a + right * 4, b + right * 4, 4) == 0) right--;
+            if (left < x0) x0 = left;
+            if (right > x1) x1 = right;
+            if (y < y0) y0 = y;
+            y1 = y;
+        }
+
+        if (y0 > y1) {
+            // Held frame: nothing changed, so it is not stored at all
+            merged_frames++;
+            return false;
+        }
+
+        frame.x = x0;
+        frame.y = y0;
+        frame.width = x1 - x0 + 1;
+        frame.height = y1 - y0 + 1;
+
+        // Redrawing most of the canvas costs as much as a keyframe
+        frame.keyframe = since_keyframe + 1 >= KEYFRAME_INTERVAL ||
+                         (size_t)frame.width * frame.height * 2 > (size_t)width * height;
+    }
+
+    if (frame.keyframe) {
+        frame.x = frame.y = 0;
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.assign(image, image + stride * height);
+        since_keyframe = 0;
+    } else {
+        frame.pixels.resize((size_t)frame.width * frame.height * 4);
+        for (uint32_t row = 0; row < frame.height; row++) {
+            memcpy(frame.pixels.data() + (size_t)row * frame.width * 4,
+                   image + (frame.y + row) * stride + (size_t)frame.x * 4, (size_t)frame.width * 4);
+        }
+        since_keyframe++;
+    }
+
+    // Looping animations repeat the same rectangles (the mouth opening
+    // again), which then share one texture
+    uint64_t hash = hash_rect(frame.pixels, frame.width, frame.height);
+    auto range = by_hash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Frame& other = frames[it->second];
+        if (other.width == frame.width && other.height == frame.height && other.pixels == frame.pixels) {
+            frame.source = it->second;
+            saved_bytes += frame.pixels.size();
+            reused_rects++;
+            std::vector<uint8_t>().swap(frame.pixels);
+            break;
+        }
+    }
+    if (frame.source == SIZE_MAX) by_hash.emplace(hash, frames.size());
+
+    frames.push_back(std::move(frame));
+    previous.assign(image, image + stride * height);
+    return true;
+}
+
+bool DeltaFrames::Upload() {
+    if (frames.empty()) return false;
+
+    for (auto& f : frames) {
+        if (f.texture) continue;
+        if (f.source != SIZE_MAX) {
+            f.texture = frames[f.source].texture;
+            continue;
+        }
+
+        const uint8_t* data_ptr = f.pixels.data();
+        f.texture = gs_texture_create(f.width, f.height, GS_RGBA, 1, &data_ptr, 0);
+        if (!f.texture) {
+            BLOG(LOG_WARNING, "Failed to create texture for frame");
+            return false;
+        }
+        std::vector<uint8_t>().swap(f.pixels); // GPU owns it now
+    }
+    std::vector<uint8_t>().swap(previous);
+    by_hash.clear();
+    return true;
+}
+
+// Copies one stored rectangle onto the canvas, replacing what is there
+void DeltaFrames::Draw(const Frame& frame) const {
+    if (!frame.texture) return;
+
+    gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), frame.texture);
+
+    gs_matrix_push();
+    gs_matrix_translate3f((float)frame.x, (float)frame.y, 0.0f);
+    while (gs_effect_loop(effect, "Draw"))
+        gs_draw_sprite(frame.texture, 0, frame.width, frame.height);
+    gs_matrix_pop();
+}
+
+void DeltaFrames::Render(DeltaCanvas& canvas, size_t index) const {
+    if (index >= frames.size() || index == canvas.rendered) return;
+
+    if (!canvas.texture) {
+        canvas.texture = gs_texture_create(width, height, GS_RGBA, 1, nullptr, GS_RENDER_TARGET);
+        if (!canvas.texture) {
+            BLOG(LOG_WARNING, "Failed to create canvas texture");
+            return;
+        }
+        canvas.rendered = SIZE_MAX;
+    }
+
+    // Continue from the frame on the canvas when playing forward within the
+    // same keyframe span, otherwise start over from the keyframe
+    size_t key = index;
+    while (!frames[key].keyframe) key--;
+    size_t start = (canvas.rendered >= key && canvas.rendered < index) ? canvas.rendered + 1 : key;
+
+    gs_texture_t* prev_target = gs_get_render_target();
+    gs_zstencil_t* prev_zstencil = gs_get_zstencil_target();
+    const bool prev_srgb = gs_framebuffer_srgb_enabled();
+
+    gs_viewport_push();
+    gs_projection_push();
+    gs_matrix_push();
+    gs_matrix_identity();
+
+    gs_set_render_target(canvas.texture, nullptr);
+    gs_set_viewport(0, 0, width, height);
+    gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+    gs_enable_framebuffer_srgb(false);
+
+    // Rectangles replace the canvas pixels, alpha included
+    gs_blend_state_push();
+    gs_enable_blending(false);
+    for (size_t i = start; i <= index; i++)
+        Draw(frames[i]);
+    gs_blend_state_pop();
+
+    gs_enable_framebuffer_srgb(prev_srgb);
+    gs_set_render_target(prev_target, prev_zstencil);
+    gs_matrix_pop();
+    gs_projection_pop();
+    gs_viewport_pop();
+
+    canvas.rendered = index;
+}
+
+size_t DeltaFrames::GetRamSize() const {
+    size_t bytes = previous.size();
+    for (const auto& f : frames) bytes += f.pixels.size();
+    return bytes;
+}
+
+size_t DeltaFrames::GetVramSize() const {
+    size_t bytes = !frames.empty() ? (size_t)width * height * 4 : 0;
+    for (const auto& f : frames) {
+        if (f.source == SIZE_MAX) bytes += (size_t)f.width * f.height * 4;
+    }
+    return bytes;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+#include <map>
+#include <vector>
+
+// Compact storage for fully decoded animations. Most avatar frames only
+// change a small region (mouth, eyes), so instead of one full-canvas texture
+// per frame, each frame keeps just the rectangle that differs from the frame
+// before it. The visible frame is rebuilt on the GPU by drawing those
+// rectangles over the last keyframe into a canvas texture. The rectangles
+// are shared; each viewer has its own DeltaCanvas, so sources sharing the
+// animation at different playheads each keep their own frame.
+//
+// A full keyframe is stored every KEYFRAME_INTERVAL frames, and wherever the
+// change covers most of the canvas anyway, so rebuilding any frame draws at
+// most one keyframe and KEYFRAME_INTERVAL - 1 rectangles. Playing forward
+// draws one rectangle per frame.
+// Render target one viewer rebuilds its frames into. Created on the first
+// DeltaFrames::Render().
+struct DeltaCanvas {
+    gs_texture_t* texture = nullptr;
+    size_t rendered = SIZE_MAX; // Frame the texture shows
+
+    // Caller must hold the graphics context if a texture was created
+    void Free() {
+        if (texture) gs_texture_destroy(texture);
+        texture = nullptr;
+        rendered = SIZE_MAX;
+    }
+};
+
+class DeltaFrames {
+public:
+    static const size_t KEYFRAME_INTERVAL = 8;
+
+    DeltaFrames(uint32_t width, uint32_t height);
+    ~DeltaFrames();
+
+    // Appends the next full RGBA canvas (width * height * 4 bytes), keeping
+    // only what changed. Returns false if it is identical to the previous
+    // frame; the caller then extends that frame's delay instead. A rectangle
+    // identical to an earlier one reuses its texture. CPU only.
+    bool Add(const uint8_t* image);
+
+    // Creates the rectangle textures. Caller must hold the graphics context.
+    bool Upload();
+
+    // Rebuilds frame `index` into `canvas`. Draws with its own effect pass,
+    // so call it with the graphics context held but outside video_render
+    // (from video_tick).
+    void Render(DeltaCanvas& canvas, size_t index) const;
+
+    size_t GetFrameCount() const { return frames.size(); }
+
+    // Pixels waiting for Upload(); 0 afterwards
+    size_t GetRamSize() const;
+    // Rectangles and keyframes plus one canvas
+    size_t GetVramSize() const;
+
+    // Deduplication results, for the load log
+    size_t GetMergedFrames() const { return merged_frames; }
+    size_t GetReusedRects() const { return reused_rects; }
+    size_t GetSavedBytes() const { return saved_bytes; }
+
+    DeltaFrames(const DeltaFrames&) = delete;
+    DeltaFrames& operator=(const DeltaFrames&) = delete;
+
+private:
+    struct Frame {
+        bool keyframe = false;
+        uint32_t x = 0, y = 0;          // Changed rectangle; a keyframe covers the canvas
+        uint32_t width = 0, height = 0; // Never empty: unchanged frames are merged
+        std::vector<uint8_t> pixels;    // Released after Upload()
+        gs_texture_t* texture = nullptr;
+        size_t source = SIZE_MAX;       // Earlier frame whose identical texture this one reuses
+    };
+
+    void Draw(const Frame& frame) const;
+
+    uint32_t width;
+    uint32_t height;
+    std::vector<Frame> frames;
+    std::vector<uint8_t> previous; // Last canvas passed to Add()
+    size_t since_keyframe = 0;     // Deltas stored since the last keyframe
+    std::multimap<uint64_t, size_t> by_hash; // Rectangle hash -> frame storing those pixels
+
+    size_t merged_frames = 0;
+    size_t reused_rects = 0;
+    size_t saved_bytes = 0;
+};
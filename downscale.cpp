@@ -0,0 +1,176 @@
+#include "downscale.h"
+#include <algorithm>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DOWNSCALE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define DOWNSCALE_NEON
+#include <arm_neon.h>
+#endif
+
+// One pixel as four float lanes (r, g, b, a). Colors are premultiplied by
+// alpha (0..255) while summing and divided back out when storing.
+#if defined(DOWNSCALE_SSE2)
+
+typedef __m128 pixel4;
+
+static inline pixel4 pixel_zero() { return _mm_setzero_ps(); }
+static inline pixel4 pixel_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void pixel_store(float* p, pixel4 v) { _mm_storeu_ps(p, v); }
+static inline pixel4 pixel_madd(pixel4 acc, pixel4 v, float w) { return _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(w))); }
+
+// (a, a, a, 1) with `a` taken from lane 3 of v
+static inline __m128 alpha_factor(__m128 v) {
+    const __m128 alpha_lane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    __m128 a = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_or_ps(_mm_andnot_ps(alpha_lane, a), _mm_and_ps(alpha_lane, _mm_set1_ps(1.0f)));
+}
+
+static inline pixel4 pixel_load_premul(const uint8_t* p) {
+    int32_t word;
+    memcpy(&word, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+    __m128 f = _mm_cvtepi32_ps(v);
+    return _mm_mul_ps(f, alpha_factor(f));
+}
+
+static inline void pixel_store_unpremul(uint8_t* p, pixel4 v) {
+    // A fully transparent sum is all zeros, so any non-zero divisor works
+    __m128 d = _mm_max_ps(alpha_factor(v), _mm_set1_ps(1e-6f));
+    __m128i i = _mm_cvttps_epi32(_mm_add_ps(_mm_div_ps(v, d), _mm_set1_ps(0.5f)));
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    int32_t word = _mm_cvtsi128_si32(i);
+    memcpy(p, &word, 4);
+}
+
+#elif defined(DOWNSCALE_NEON)
+
+typedef float32x4_t pixel4;
+
+static inline pixel4 pixel_zero() { return vdupq_n_f32(0.0f); }
+static inline pixel4 pixel_load(const float* p) { return vld1q_f32(p); }
+static inline void pixel_store(float* p, pixel4 v) { vst1q_f32(p, v); }
+static inline pixel4 pixel_madd(pixel4 acc, pixel4 v, float w) { return vmlaq_n_f32(acc, v, w); }
+
+static inline pixel4 pixel_load_premul(const uint8_t* p) {
+    uint32_t word;
+    memcpy(&word, p, 4);
+    uint16x8_t w16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(word)));
+    float32x4_t f = vcvtq_f32_u32(vmovl_u16(vget_low_u16(w16)));
+    float a = vgetq_lane_f32(f, 3);
+    return vsetq_lane_f32(a, vmulq_n_f32(f, a), 3);
+}
+
+static inline void pixel_store_unpremul(uint8_t* p, pixel4 v) {
+    float a = vgetq_lane_f32(v, 3);
+    float32x4_t c = vsetq_lane_f32(a, vmulq_n_f32(v, a > 0.0f ? 1.0f / a : 0.0f), 3);
+    uint32x4_t i = vcvtq_u32_f32(vaddq_f32(c, vdupq_n_f32(0.5f)));
+    uint8x8_t b = vqmovn_u16(vcombine_u16(vqmovn_u32(i), vqmovn_u32(i)));
+    uint32_t word = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+    memcpy(p, &word, 4);
+}
+
+#else
+
+struct pixel4 {
+    float v[4];
+};
+
+static inline pixel4 pixel_zero() { return pixel4{{0.0f, 0.0f, 0.0f, 0.0f}}; }
+static inline pixel4 pixel_load(const float* p) {
+    pixel4 r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+static inline void pixel_store(float* p, pixel4 v) { memcpy(p, v.v, sizeof(v.v)); }
+static inline pixel4 pixel_madd(pixel4 acc, pixel4 v, float w) {
+    for (int c = 0; c < 4; c++)
+        acc.v[c] += v.v[c] * w;
+    return acc;
+}
+
+static inline pixel4 pixel_load_premul(const uint8_t* p) {
+    float a = p[3];
+    return pixel4{{p[0] * a, p[1] * a, p[2] * a, a}};
+}
+
+static inline void pixel_store_unpremul(uint8_t* p, pixel4 v) {
+    float a = v.v[3];
+    float inv = a > 0.0f ? 1.0f / a : 0.0f;
+    for (int c = 0; c < 4; c++) {
+        float f = (c == 3 ? a : v.v[c] * inv) + 0.5f;
+        p[c] = (uint8_t)(f < 0.0f ? 0 : f > 255.0f ? 255 : (int)f);
+    }
+}
+
+#endif
+
+Downscaler::Downscaler(uint32_t src_width, uint32_t src_height, uint32_t dst_width, uint32_t dst_height)
+    : src_width(src_width), src_height(src_height), dst_width(dst_width), dst_height(dst_height) {
+    BuildTaps(src_width, dst_width, x_taps, x_starts);
+    BuildTaps(src_height, dst_height, y_taps, y_starts);
+    row.resize((size_t)dst_width * 4);
+    sum.resize((size_t)dst_width * 4);
+}
+
+// Output sample o covers source range [o * scale, (o + 1) * scale); each
+// source sample it touches is weighted by how much of it is covered
+void Downscaler::BuildTaps(uint32_t src, uint32_t dst, std::vector<Tap>& taps, std::vector<uint32_t>& starts) {
+    const double scale = (double)src / dst;
+    for (uint32_t o = 0; o < dst; o++) {
+        starts.push_back((uint32_t)taps.size());
+        double begin = o * scale, end = begin + scale;
+        for (uint32_t i = (uint32_t)begin; i < src && i < end; i++) {
+            double cover = std::min(end, i + 1.0) - std::max(begin, (double)i);
+            if (cover > 1e-9) taps.push_back(Tap{i, (float)(cover / scale)});
+        }
+    }
+    starts.push_back((uint32_t)taps.size());
+}
+
+void Downscaler::ResampleRow(const uint8_t* src_row, float* out) {
+    for (uint32_t x = 0; x < dst_width; x++) {
+        pixel4 acc = pixel_zero();
+        for (uint32_t t = x_starts[x]; t < x_starts[x + 1]; t++)
+            acc = pixel_madd(acc, pixel_load_premul(src_row + (size_t)x_taps[t].index * 4), x_taps[t].weight);
+        pixel_store(out + (size_t)x * 4, acc);
+    }
+}
+
+void Downscaler::Run(const uint8_t* src, uint8_t* dst) {
+    const size_t src_stride = (size_t)src_width * 4;
+    uint32_t resampled = UINT32_MAX; // Source row currently in `row`
+
+    for (uint32_t y = 0; y < dst_height; y++) {
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (uint32_t t = y_starts[y]; t < y_starts[y + 1]; t++) {
+            // A source row straddling two output rows is resampled once
+            if (y_taps[t].index != resampled) {
+                resampled = y_taps[t].index;
+                ResampleRow(src + resampled * src_stride, row.data());
+            }
+            const float w = y_taps[t].weight;
+            for (uint32_t x = 0; x < dst_width; x++) {
+                float* s = sum.data() + (size_t)x * 4;
+                pixel_store(s, pixel_madd(pixel_load(s), pixel_load(row.data() + (size_t)x * 4), w));
+            }
+        }
+
+        uint8_t* out = dst + (size_t)y * dst_width * 4;
+        for (uint32_t x = 0; x < dst_width; x++)
+            pixel_store_unpremul(out + (size_t)x * 4, pixel_load(sum.data() + (size_t)x * 4));
+    }
+}
+
+bool Downscaler::Fit(uint32_t width, uint32_t height, uint32_t max_dim, uint32_t& out_width, uint32_t& out_height) {
+    if (max_dim == 0 || (width <= max_dim && height <= max_dim)) return false;
+
+    const double scale = (double)max_dim / std::max(width, height);
+    out_width = std::max<uint32_t>(1, (uint32_t)(width * scale + 0.5));
+    out_height = std::max<uint32_t>(1, (uint32_t)(height * scale + 0.5));
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Area-average (box) downscaling of RGBA8 images, used to cap the texture
+// size of oversized avatars. Each output pixel is the coverage-weighted mean
+// of the source pixels under it, with colors weighted by alpha so
+// transparent edges do not darken. Runs on SSE2 or NEON where available.
+class Downscaler {
+public:
+    Downscaler(uint32_t src_width, uint32_t src_height, uint32_t dst_width, uint32_t dst_height);
+
+    // `src` is src_width x src_height, `dst` dst_width x dst_height (RGBA8,
+    // straight alpha). The channel order does not matter beyond alpha last.
+    void Run(const uint8_t* src, uint8_t* dst);
+
+    // Size of a width x height image whose longer side is capped at
+    // `max_dim`, keeping the aspect ratio. Returns false (and leaves the
+    // outputs alone) if it already fits or `max_dim` is 0.
+    static bool Fit(uint32_t width, uint32_t height, uint32_t max_dim, uint32_t& out_width, uint32_t& out_height);
+
+private:
+    // Source sample contributing to an output sample, weighted by coverage
+    struct Tap {
+        uint32_t index;
+        float weight;
+    };
+    static void BuildTaps(uint32_t src, uint32_t dst, std::vector<Tap>& taps, std::vector<uint32_t>& starts);
+    void ResampleRow(const uint8_t* row, float* out);
+
+    uint32_t src_width, src_height, dst_width, dst_height;
+    std::vector<Tap> x_taps, y_taps;
+    std::vector<uint32_t> x_starts, y_starts; // Output sample i uses taps [starts[i], starts[i + 1])
+    std::vector<float> row;                   // Horizontally resampled source row (premultiplied)
+    std::vector<float> sum;                   // Output row being accumulated
+};
@@ -0,0 +1,203 @@
+#include "file-watcher.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#define BLOG(level, format, ...) blog(level, "[File-Watcher] " format, ##__VA_ARGS__)
+
+using Clock = std::chrono::steady_clock;
+
+// Quiet time after the last write before the change is reported. Long
+// enough to cover the save sequence of common image editors.
+static const std::chrono::milliseconds DEBOUNCE(300);
+
+FileWatcher::FileWatcher(Callback on_change) : on_change(std::move(on_change)) {
+#ifdef __linux__
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd < 0 || wake_fd < 0) {
+        BLOG(LOG_WARNING, "inotify unavailable, hot reload disabled");
+        return;
+    }
+#endif
+    thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    Wake();
+    if (thread.joinable()) thread.join();
+
+#ifdef __linux__
+    if (inotify_fd >= 0) close(inotify_fd);
+    if (wake_fd >= 0) close(wake_fd);
+#endif
+}
+
+void FileWatcher::SetFiles(const std::vector<std::string>& list) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::set<std::string> next(list.begin(), list.end());
+        if (next == files) return;
+        files.swap(next);
+        files_changed = true;
+    }
+    Wake();
+}
+
+#ifdef __linux__
+
+void FileWatcher::Wake() {
+    if (wake_fd < 0) return;
+    uint64_t one = 1;
+    ssize_t r = write(wake_fd, &one, sizeof(one));
+    (void)r;
+}
+
+// Watches the folder of every file. Watching folders rather than the files
+// themselves survives editors that save by writing a temp file and renaming
+// it over the original.
+void FileWatcher::UpdateWatches() {
+    for (const auto& w : dir_watches)
+        inotify_rm_watch(inotify_fd, w.first);
+    dir_watches.clear();
+
+    std::set<std::string> dirs;
+    for (const auto& path : watched) {
+        size_t slash = path.find_last_of('/');
+        if (slash != std::string::npos) dirs.insert(path.substr(0, slash));
+    }
+
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+    for (const auto& dir : dirs) {
+        int wd = inotify_add_watch(inotify_fd, dir.c_str(), mask);
+        if (wd < 0) {
+            BLOG(LOG_WARNING, "Cannot watch folder: %s", dir.c_str());
+            continue;
+        }
+        dir_watches[wd] = dir;
+    }
+    BLOG(LOG_DEBUG, "Watching %zu files in %zu folders", watched.size(), dir_watches.size());
+}
+
+void FileWatcher::Run() {
+    bool pending = false;
+    Clock::time_point deadline;
+
+    for (;;) {
+        bool replaced = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+            if (files_changed) {
+                watched = files;
+                files_changed = false;
+                replaced = true;
+            }
+        }
+        if (replaced) UpdateWatches();
+
+        int timeout = -1;
+        if (pending) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            timeout = left.count() > 0 ? (int)left.count() : 0;
+        }
+
+        struct pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+        poll(fds, 2, timeout);
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t r = read(wake_fd, &count, sizeof(count));
+            (void)r;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            alignas(struct inotify_event) char buf[4096];
+            ssize_t len;
+            while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+                for (char* p = buf; p < buf + len;) {
+                    const struct inotify_event* ev = (const struct inotify_event*)p;
+                    p += sizeof(struct inotify_event) + ev->len;
+
+                    auto dir = dir_watches.find(ev->wd);
+                    if (ev->len == 0 || dir == dir_watches.end()) continue;
+
+                    std::string path = dir->second + "/" + ev->name;
+                    if (watched.count(path)) {
+                        BLOG(LOG_DEBUG, "Changed: %s", path.c_str());
+                        pending = true;
+                        deadline = Clock::now() + DEBOUNCE;
+                    }
+                }
+            }
+        }
+
+        if (pending && Clock::now() >= deadline) {
+            pending = false;
+            on_change();
+        }
+    }
+}
+
+#else
+
+// Other platforms poll the files; this is a handful of stat() calls
+static const std::chrono::milliseconds POLL_INTERVAL(250);
+
+void FileWatcher::Wake() {
+    cv.notify_all();
+}
+
+bool FileWatcher::PollChanges(const std::set<std::string>& list) {
+    bool changed = false;
+    std::map<std::string, std::pair<int64_t, int64_t>> next;
+    for (const auto& path : list) {
+        std::pair<int64_t, int64_t> stamp(-1, 0);
+        struct stat st;
+        if (os_stat(path.c_str(), &st) == 0)
+            stamp = std::make_pair((int64_t)st.st_size, (int64_t)st.st_mtime);
+
+        auto it = stamps.find(path);
+        if (it != stamps.end() && it->second != stamp) changed = true;
+        next[path] = stamp;
+    }
+    stamps.swap(next);
+    return changed;
+}
+
+void FileWatcher::Run() {
+    bool pending = false;
+    Clock::time_point last_change;
+
+    for (;;) {
+        std::set<std::string> list;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait_for(lock, POLL_INTERVAL, [this] { return stopping || files_changed; });
+            if (stopping) return;
+            files_changed = false;
+            list = files;
+        }
+
+        if (PollChanges(list)) {
+            pending = true;
+            last_change = Clock::now();
+        } else if (pending && Clock::now() - last_change >= DEBOUNCE) {
+            pending = false;
+            on_change();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a set of image files and calls back once a burst of writes to any
+// of them has settled, so editors that save in several steps (truncate,
+// write, rename) trigger a single reload. Uses inotify on the files' folders
+// on Linux and polls the files' size and mtime elsewhere.
+//
+// The callback runs on the watcher's own thread. Destroying the watcher
+// waits for a running callback to return.
+class FileWatcher {
+public:
+    using Callback = std::function<void()>;
+
+    explicit FileWatcher(Callback on_change);
+    ~FileWatcher();
+
+    // Replaces the watched files (absolute paths). Events for other files in
+    // the same folders (settings.ini, editor temp files) are ignored.
+    void SetFiles(const std::vector<std::string>& files);
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+private:
+    void Run();
+    void Wake();
+
+    Callback on_change;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<std::string> files;
+    bool files_changed = false;
+    bool stopping = false;
+    std::thread thread;
+
+#ifdef __linux__
+    int inotify_fd = -1;
+    int wake_fd = -1;
+    std::map<int, std::string> dir_watches; // inotify watch descriptor -> folder
+    std::set<std::string> watched;          // Copy of `files` for the watcher thread
+
+    void UpdateWatches();
+#else
+    std::map<std::string, std::pair<int64_t, int64_t>> stamps; // path -> size, mtime
+
+    // Returns true if any watched file changed since the last call
+    bool PollChanges(const std::set<std::string>& list);
+#endif
+};
@@ -4,12 +4,23 @@
 #include <util/config-file.h>
 #include <util/platform.h>
 #include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <shellapi.h>
 #endif
 
+// Image file names every avatar folder may contain
+static const char *avatar_image_files[] = {
+	"idle.png", "blink.png", "action.png",
+	"talk_a.png", "talk_b.png", "talk_c.png",
+	"talk_a_blink.png", "talk_b_blink.png", "talk_c_blink.png",
+	NULL
+};
+
 // Returns the custom avatars folder path from source settings.
 // Returns NULL if not set. Do NOT free the returned pointer.
 static const char *get_custom_dir(obs_data_t *settings)
@@ -60,6 +71,49 @@ static char *resolve_avatar_dir(const char *avatar_name, obs_data_t *settings)
 }
 
 
+// Adds the subfolder names of `dir` to `names`, skipping duplicates
+static void collect_avatar_names(const char *dir, std::vector<std::string> &names)
+{
+	if (!dir || !*dir || !os_file_exists(dir)) return;
+	os_dir_t *d = os_opendir(dir);
+	if (!d) return;
+	struct os_dirent *ent;
+	while ((ent = os_readdir(d)) != NULL) {
+		if (!ent->directory || ent->d_name[0] == '.') continue;
+		if (std::find(names.begin(), names.end(), ent->d_name) == names.end())
+			names.push_back(ent->d_name);
+	}
+	os_closedir(d);
+}
+
+void enum_library_images(obs_data_t *settings,
+                         void (*callback)(void *param, const char *path),
+                         void *param)
+{
+	std::vector<std::string> names;
+	char *data_dir = obs_module_file("avatars");
+	collect_avatar_names(data_dir, names);
+	bfree(data_dir);
+	collect_avatar_names(get_custom_dir(settings), names);
+
+	for (const std::string &name : names) {
+		// Same resolution as "Load & Apply", so the paths match exactly
+		char *base_dir = resolve_avatar_dir(name.c_str(), settings);
+		if (!base_dir) continue;
+
+		for (int i = 0; avatar_image_files[i]; i++) {
+			struct dstr path = {0};
+			dstr_copy(&path, base_dir);
+			dstr_cat(&path, "/");
+			dstr_cat(&path, avatar_image_files[i]);
+			if (os_file_exists(path.array))
+				callback(param, path.array);
+			dstr_free(&path);
+		}
+		bfree(base_dir);
+	}
+}
+
 // Enumerate audio sources for the dropdown list
 static bool enum_audio_sources(void *data, obs_source_t *source)
 {
@@ -176,6 +230,13 @@ void flood_tuber_defaults(obs_data_t *settings)
 	apply_avatar_to_settings(settings, "Flood Tuber Avatar", true);
 	obs_data_set_default_string(settings, "avatar_list", "Flood Tuber Avatar");
 	obs_data_set_default_string(settings, "custom_avatars_path", "");
+	obs_data_set_default_bool(settings,   "prewarm_library",    false);
+	obs_data_set_default_int(settings,    "prewarm_budget_mb",    512);
+	obs_data_set_default_bool(settings,   "hot_reload",         false);
+	obs_data_set_default_string(settings, "memory_policy",  "resident");
+	obs_data_set_default_string(settings, "playback_mode",  "file");
+	obs_data_set_default_int(settings,    "playback_loops",       3);
+	obs_data_set_default_int(settings,    "max_texture_size",     0);
 	obs_data_set_default_string(settings, "hint_custom_folder", obs_module_text("hint_custom_folder"));
 
 	// Group hint text (always-visible info boxes in the properties panel)
@@ -332,12 +393,7 @@ static bool save_settings_to_avatar(obs_properties_t *props, obs_property_t *p,
 		// If source is from data dir (built-in), copy images to custom dir
 		if (strcmp(source_dir, target_dir.array) != 0) {
 			BLOG(LOG_INFO, "save_settings: copying images from %s to %s", source_dir, target_dir.array);
-			const char *files[] = {
-				"idle.png", "blink.png", "action.png",
-				"talk_a.png", "talk_b.png", "talk_c.png",
-				"talk_a_blink.png", "talk_b_blink.png", "talk_c_blink.png",
-				NULL
-			};
+			const char **files = avatar_image_files;
 			for (int i = 0; files[i]; i++) {
 				struct dstr src = {0}, dst = {0};
 				dstr_copy(&src, source_dir);
@@ -547,6 +603,16 @@ static bool on_motion_type_changed(obs_properties_t *props, obs_property_t *p,
 	return true;
 }
 
+// Shows the loop count only for the mode that uses it
+static bool on_playback_mode_changed(obs_properties_t *props, obs_property_t *p,
+                                     obs_data_t *settings)
+{
+	(void)p;
+	const char *mode = obs_data_get_string(settings, "playback_mode");
+	bool show = mode && strcmp(mode, "loop_n") == 0;
+	obs_property_set_visible(obs_properties_get(props, "playback_loops"), show);
+	return true;
+}
 
 // Helper: adds custom dir avatar entries to a list property, avoiding duplicates
 static void populate_custom_avatars(obs_property_t *list, const char *custom_path)
@@ -680,6 +746,19 @@ obs_properties_t *flood_tuber_properties(void *data)
 	obs_properties_add_button(lib, "open_folder_btn",
 		obs_module_text("open_folder_btn"), open_library_folder);
 
+	// Background decode of the whole library for instant avatar switching
+	obs_property_t *p_prewarm = obs_properties_add_bool(lib, "prewarm_library",
+		obs_module_text("prewarm_library"));
+	obs_property_set_long_description(p_prewarm, obs_module_text("prewarm_library_tooltip"));
+	obs_property_t *p_budget = obs_properties_add_int(lib, "prewarm_budget_mb",
+		obs_module_text("prewarm_budget_mb"), 64, 8192, 64);
+	obs_property_set_long_description(p_budget, obs_module_text("prewarm_budget_mb_tooltip"));
+
+	// Reload images edited on disk without pressing Load & Apply
+	obs_property_t *p_reload = obs_properties_add_bool(lib, "hot_reload",
+		obs_module_text("hot_reload"));
+	obs_property_set_long_description(p_reload, obs_module_text("hot_reload_tooltip"));
+
 	// ── 2. Avatar Images ───────────────────────────────────────────────────
 	obs_properties_t *img = obs_properties_create();
 	obs_properties_add_group(props, "images_group",
@@ -713,6 +792,34 @@ obs_properties_t *flood_tuber_properties(void *data)
 	add_file_prop(img, "path_talk_3_blink", obs_module_text("path_talk_3_blink"), obs_module_text("path_talk_3_blink_tooltip"));
 	obs_properties_add_button(img, "clear_talk_3_blink", clear_txt, clear_talk_3_blink);
 
+	// Long animations: all frames in VRAM, compressed in RAM, or streamed
+	obs_property_t *p_policy = obs_properties_add_list(img, "memory_policy",
+		obs_module_text("memory_policy"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(p_policy, obs_module_text("memory_policy_resident"),  "resident");
+	obs_property_list_add_string(p_policy, obs_module_text("memory_policy_compressed"), "compressed");
+	obs_property_list_add_string(p_policy, obs_module_text("memory_policy_streaming"), "streaming");
+	obs_property_set_long_description(p_policy, obs_module_text("memory_policy_tooltip"));
+
+	obs_property_t *p_playback = obs_properties_add_list(img, "playback_mode",
+		obs_module_text("playback_mode"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(p_playback, obs_module_text("playback_mode_file"),      "file");
+	obs_property_list_add_string(p_playback, obs_module_text("playback_mode_loop"),      "loop");
+	obs_property_list_add_string(p_playback, obs_module_text("playback_mode_once"),      "once");
+	obs_property_list_add_string(p_playback, obs_module_text("playback_mode_loop_n"),    "loop_n");
+	obs_property_list_add_string(p_playback, obs_module_text("playback_mode_ping_pong"), "ping_pong");
+	obs_property_set_long_description(p_playback, obs_module_text("playback_mode_tooltip"));
+	obs_property_set_modified_callback(p_playback, on_playback_mode_changed);
+
+	obs_property_t *p_loops = obs_properties_add_int(img, "playback_loops",
+		obs_module_text("playback_loops"), 1, 1000, 1);
+	obs_property_set_long_description(p_loops, obs_module_text("playback_loops_tooltip"));
+
+	// Oversized artwork is stored at a capped resolution; 0 keeps full size
+	obs_property_t *p_max_size = obs_properties_add_int(img, "max_texture_size",
+		obs_module_text("max_texture_size"), 0, 16384, 64);
+	obs_property_int_set_suffix(p_max_size, " px");
+	obs_property_set_long_description(p_max_size, obs_module_text("max_texture_size_tooltip"));
+
 	// ── 3. Audio & Trigger ─────────────────────────────────────────────────
 	obs_properties_t *audio = obs_properties_create();
 	obs_properties_add_group(props, "audio_settings",
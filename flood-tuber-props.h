@@ -6,3 +6,9 @@
 
 obs_properties_t *flood_tuber_properties(void *data);
 void              flood_tuber_defaults(obs_data_t *settings);
+
+// Calls `callback` with the path of every existing image of every avatar in
+// the library dropdown (built-in avatars plus the custom avatars folder)
+void              enum_library_images(obs_data_t *settings,
+                                      void (*callback)(void *param, const char *path),
+                                      void *param);
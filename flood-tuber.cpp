@@ -1,45 +1,39 @@
 #include "flood-tuber.h"
 #include "flood-tuber-props.h"
+#include "worker-pool.h"
+#include "image-format.h"
+#include "png-inflate.h"
+#include "downscale.h"
 #include <util/dstr.h>
+#include <util/platform.h>
 #include <math.h>
+#include <algorithm>
 
+// Settings key and storage for every image slot
+static const struct {
+	const char *setting;
+	FloodImage flood_tuber_data::*image;
+	bool one_shot; // Shown for a moment (blink, action); finite playback modes apply
+} image_slots[] = {
+	{"path_idle",         &flood_tuber_data::image_idle,            false},
+	{"path_blink",        &flood_tuber_data::image_blink,           true},
+	{"path_action",       &flood_tuber_data::image_action,          true},
+	{"path_talk_1",       &flood_tuber_data::image_talking_1,       false},
+	{"path_talk_2",       &flood_tuber_data::image_talking_2,       false},
+	{"path_talk_3",       &flood_tuber_data::image_talking_3,       false},
+	{"path_talk_1_blink", &flood_tuber_data::image_talking_1_blink, true},
+	{"path_talk_2_blink", &flood_tuber_data::image_talking_2_blink, true},
+	{"path_talk_3_blink", &flood_tuber_data::image_talking_3_blink, true},
+};
+static_assert(sizeof(image_slots) / sizeof(image_slots[0]) == IMAGE_SLOT_COUNT,
+	"image_slots[] must cover every FloodImage in flood_tuber_data");
 
-// Validate file headers to prevent crashes (e.g. renamed .txt files)
-static bool check_file_signature(const char *path) {
-    if (!path || !*path) return false;
-    
-    FILE *f = fopen(path, "rb");
-    if (!f) return false;
-    
-    unsigned char sig[12] = {0};
-    size_t len = fread(sig, 1, 12, f);
-    fclose(f);
-    
+// Validate file headers to prevent crashes (e.g. renamed .txt files).
+// Known formats were already matched by sniff_image_format().
+static bool check_file_signature(const ImageFormatInfo *format, size_t len, const char *path) {
+    if (format) return true;
     if (len < 4) return false; // Too small to be valid image
 
-    // Check GIF: "GIF87a" or "GIF89a"
-    if (len >= 6 && sig[0] == 'G' && sig[1] == 'I' && sig[2] == 'F' && 
-        sig[3] == '8' && (sig[4] == '7' || sig[4] == '9') && sig[5] == 'a') {
-        return true; 
-    }
-
-    // Check PNG: 89 50 4E 47 0D 0A 1A 0A
-    if (len >= 8 && sig[0] == 0x89 && sig[1] == 0x50 && sig[2] == 0x4E && sig[3] == 0x47 &&
-        sig[4] == 0x0D && sig[5] == 0x0A && sig[6] == 0x1A && sig[7] == 0x0A) {
-        return true;
-    }
-
-    // Check WebP: RIFF .... WEBP
-    if (len >= 12 && sig[0] == 'R' && sig[1] == 'I' && sig[2] == 'F' && sig[3] == 'F' &&
-        sig[8] == 'W' && sig[9] == 'E' && sig[10] == 'B' && sig[11] == 'P') {
-        return true;
-    }
-
-    // Check JPEG: FF D8 FF
-    if (len >= 3 && sig[0] == 0xFF && sig[1] == 0xD8 && sig[2] == 0xFF) {
-        return true;
-    }
-
     // Allow others if we are brave, but for GIF specifically we MUST validate 
     // because OBS crashes on corrupt GIFs.
     const char *ext = strrchr(path, '.');
@@ -50,110 +44,612 @@ static bool check_file_signature(const char *path) {
     return true; // Let OBS try other formats (BMP, TGA etc) if not explicitly suspicious
 }
 
-// Loads an image file and initializes its texture
-static void update_image(FloodImage *image, const char *path)
+// Shrinks a still image decoded by OBS to fit `max_dim`. Animated GIFs
+// decode their frames during playback and keep their full size.
+static void downscale_obs_image(FloodAsset *asset, uint32_t max_dim)
 {
-	obs_enter_graphics();
-	image->Free();
+    gs_image_file_t *image = &asset->obs_image;
+    if (!image->loaded || image->is_animated_gif || !image->texture_data)
+        return;
+    if (image->format != GS_RGBA && image->format != GS_BGRA)
+        return;
+
+    uint32_t cx, cy;
+    if (!Downscaler::Fit(image->cx, image->cy, max_dim, cx, cy))
+        return;
+
+    uint8_t *scaled = (uint8_t *)bmalloc((size_t)cx * cy * 4);
+    Downscaler(image->cx, image->cy, cx, cy).Run(image->texture_data, scaled);
+    bfree(image->texture_data);
+    image->texture_data = scaled;
+    asset->full_cx = image->cx;
+    asset->full_cy = image->cy;
+    image->cx = cx;
+    image->cy = cy;
+}
+
+// Decodes an image file, already read into `file`, into CPU memory. Runs on
+// a worker thread, so it must not touch the graphics context; upload_image()
+// creates the textures later. With the compressed policy, long APNG/WebP/GIF
+// animations keep their frames LZ4-compressed in RAM; with the streaming
+// policy, only the file, decoding frames during playback.
+// Images larger than `max_dim` are stored downscaled but keep reporting
+// their full size.
+static void decode_image(FloodAsset *asset, const char *path, const std::vector<uint8_t> &file,
+                         FloodMemoryPolicy policy, uint32_t max_dim)
+{
+    if (file.empty()) {
+        blog(LOG_WARNING, "Failed to read image file: %s", path);
+        return;
+    }
+
+    // Route by content, not extension: each format goes straight to its decoder
+    const ImageFormatInfo *format = sniff_image_format(file.data(), file.size());
+    if (!check_file_signature(format, file.size(), path)) {
+        blog(LOG_WARNING, "Invalid file signature (corrupt or fake file?): %s", path);
+        return;
+    }
+    FloodAsset::Type loader = format ? format->loader : FloodAsset::OBS_STANDARD;
+    asset->stats.format = format ? format->name : "other";
+    BLOG(LOG_DEBUG, "Detected %s: %s", asset->stats.format, path);
     
-    if (path && *path) {
-        if (!check_file_signature(path)) {
-            blog(LOG_WARNING, "Invalid file signature (corrupt or fake file?): %s", path);
+    FrameStorage storage = FrameStorage::RESIDENT;
+    if (policy == FloodMemoryPolicy::COMPRESSED)
+        storage = FrameStorage::COMPRESSED;
+    else if (policy == FloodMemoryPolicy::STREAMING)
+        storage = FrameStorage::STREAMING;
+    if (loader == FloodAsset::CUSTOM_WEBP) {
+        asset->type = FloodAsset::CUSTOM_WEBP;
+        asset->webp_decoder = new WebPDecoder();
+        if (!asset->webp_decoder->Load(file.data(), file.size(), storage, max_dim)) {
+             blog(LOG_WARNING, "Failed to load WebP: %s", path);
+             delete asset->webp_decoder;
+             asset->webp_decoder = nullptr;
+             asset->type = FloodAsset::OBS_STANDARD;
         } else {
-            const char *ext = strrchr(path, '.');
-            bool is_webp = (ext && (_strcmpi(ext, ".webp") == 0));
-            
-            if (is_webp) {
-                image->type = FloodImage::CUSTOM_WEBP;
-                image->webp_decoder = new WebPDecoder();
-                if (!image->webp_decoder->Load(path)) {
-                     blog(LOG_WARNING, "Failed to load WebP: %s", path);
-                     image->Free();
-                } else {
-                     blog(LOG_INFO, "Loaded WebP: %s", path);
-                }
-            } else if (ext && (_strcmpi(ext, ".apng") == 0 || _strcmpi(ext, ".png") == 0)) {
-                // Check if it's an animated PNG
-                APNGDecoder *temp_decoder = new APNGDecoder();
-                if (temp_decoder->Load(path) && temp_decoder->IsAnimated()) {
-                     image->type = FloodImage::CUSTOM_APNG;
-                     image->apng_decoder = temp_decoder;
-                     blog(LOG_INFO, "Loaded Animated PNG: %s", path);
-                } else {
-                     if (temp_decoder->IsAnimated())
-                         blog(LOG_WARNING, "Failed to load APNG (corrupt?): %s", path);
-                     
-                     // Clean up checks
-                     delete temp_decoder;
-                     
-                     // Fallback to standard OBS loader for static PNGs or if APNG load failed
-                     image->type = FloodImage::OBS_STANDARD;
-                     gs_image_file_init(&image->obs_image, path);
-                     gs_image_file_init_texture(&image->obs_image);
-                }
-            } else {
-                image->type = FloodImage::OBS_STANDARD;
-                gs_image_file_init(&image->obs_image, path);
-                gs_image_file_init_texture(&image->obs_image);
-            }
+             blog(LOG_DEBUG, "Loaded WebP: %s", path);
         }
+    } else if (loader == FloodAsset::CUSTOM_APNG) {
+        // Animated or static, the PNG is decoded once and its pixels kept
+        asset->type = FloodAsset::CUSTOM_APNG;
+        asset->apng_decoder = new APNGDecoder();
+        if (!asset->apng_decoder->Load(file.data(), file.size(), storage, max_dim)) {
+             blog(LOG_WARNING, "Failed to load PNG (corrupt?), trying OBS loader: %s", path);
+             delete asset->apng_decoder;
+             asset->apng_decoder = nullptr;
+
+             // Fallback to standard OBS loader, which is more lenient
+             asset->type = FloodAsset::OBS_STANDARD;
+             gs_image_file_init(&asset->obs_image, path);
+             downscale_obs_image(asset, max_dim);
+        } else if (asset->apng_decoder->IsAnimated()) {
+             blog(LOG_DEBUG, "Loaded Animated PNG: %s", path);
+        }
+    } else if (loader == FloodAsset::CUSTOM_GIF) {
+        // Frames are composited once here, so playback never decodes
+        asset->type = FloodAsset::CUSTOM_GIF;
+        asset->gif_decoder = new GIFDecoder();
+        if (!asset->gif_decoder->Load(file.data(), file.size(), storage, max_dim)) {
+             blog(LOG_WARNING, "Failed to load GIF (corrupt?), trying OBS loader: %s", path);
+             delete asset->gif_decoder;
+             asset->gif_decoder = nullptr;
+
+             asset->type = FloodAsset::OBS_STANDARD;
+             gs_image_file_init(&asset->obs_image, path);
+             downscale_obs_image(asset, max_dim);
+        } else if (asset->gif_decoder->IsAnimated()) {
+             blog(LOG_DEBUG, "Loaded Animated GIF: %s", path);
+        }
+    } else {
+        asset->type = FloodAsset::OBS_STANDARD;
+        gs_image_file_init(&asset->obs_image, path);
+        downscale_obs_image(asset, max_dim);
     }
-    image->anim_time_ns = 0;
-	obs_leave_graphics();
+
+    // gs_image_file keeps GIF playback state inside the image, so an
+    // animated GIF cannot be shared between slots that tick it separately
+    if (asset->obs_image.is_animated_gif)
+        asset->shareable = false;
+
+    // Same for a stream: its texture ring follows one slot's playhead
+    if ((asset->webp_decoder && asset->webp_decoder->IsStreaming()) ||
+        (asset->apng_decoder && asset->apng_decoder->IsStreaming()) ||
+        (asset->gif_decoder && asset->gif_decoder->IsStreaming()))
+        asset->shareable = false;
+}
+
+// Points a slot at the decoded asset for `key`, decoding it only if no
+// other slot or source already has it (by path or identical content).
+// Runs on a worker thread.
+static void load_image(FloodImage *image, const FloodFileKey &key, bool *shared)
+{
+    image->Free();
+    if (key.path.empty())
+        return;
+
+    image->asset = AssetCache::Get().Acquire(key, [&key](FloodAsset *asset, const std::vector<uint8_t> &file) {
+        decode_image(asset, key.path.c_str(), file, key.policy, key.max_dim);
+    }, shared);
+}
+
+// Creates textures for a decoded image, once per shared asset.
+// Caller must hold the graphics context.
+static void upload_image(FloodImage *image)
+{
+    FloodAsset *asset = image->asset.get();
+    if (!asset || asset->uploaded)
+        return;
+
+    uint64_t start_ns = os_gettime_ns();
+
+    if (asset->type == FloodAsset::CUSTOM_WEBP && asset->webp_decoder) {
+        asset->webp_decoder->Upload();
+    } else if (asset->type == FloodAsset::CUSTOM_APNG && asset->apng_decoder) {
+        asset->apng_decoder->Upload();
+    } else if (asset->type == FloodAsset::CUSTOM_GIF && asset->gif_decoder) {
+        asset->gif_decoder->Upload();
+    } else {
+        gs_image_file_init_texture(&asset->obs_image);
+    }
+    asset->uploaded = true;
+    asset->stats.upload_ns = os_gettime_ns() - start_ns;
+    asset->stats.ram_bytes = asset->GetRamSize(); // Pixels handed to the GPU are released
+    asset->stats.vram_bytes = asset->GetVramSize();
+    AssetCache::Get().UpdateRetained(asset);
 }
 
-static void flood_image_tick(FloodImage *img, uint64_t elapsed_ns) {
-    if (img->type == FloodImage::CUSTOM_WEBP) {
-        if (img->webp_decoder) {
-            img->anim_time_ns += elapsed_ns;
+// Advances a slot's playback clock and works out which point of the
+// animation to show. Returns false once there is nothing left to play
+// (still image, or a finite mode that has finished and holds its last
+// frame), so the caller can skip all per-frame work.
+static bool advance_playback(FloodImage *img, uint64_t elapsed_ns, uint64_t duration_ms, uint32_t file_plays,
+                             PlaybackMode mode, uint32_t loops, bool can_reverse)
+{
+    if (img->anim_finished)
+        return false;
+    if (duration_ms == 0) {
+        img->anim_finished = true;
+        return false;
+    }
+
+    img->anim_time_ns += elapsed_ns;
+    uint64_t t = img->anim_time_ns / 1000000ULL;
+
+    uint64_t plays = 0; // Forever
+    if (mode == PlaybackMode::ONCE)
+        plays = 1;
+    else if (mode == PlaybackMode::LOOP_N)
+        plays = loops;
+    else if (mode == PlaybackMode::FILE)
+        plays = file_plays;
+
+    if (mode == PlaybackMode::PING_PONG && can_reverse) {
+        uint64_t p = t % (2 * duration_ms);
+        img->anim_pos_ms = p < duration_ms ? p : 2 * duration_ms - 1 - p;
+    } else if (plays && t >= plays * duration_ms) {
+        // Last millisecond of the last loop: the final frame, and still
+        // moving forward for streamed animations
+        img->anim_pos_ms = plays * duration_ms - 1;
+        img->anim_finished = true;
+    } else {
+        img->anim_pos_ms = t;
+    }
+    return true;
+}
+
+// Rebuilds the slot's frame of a resident animation on its canvas. Drawing
+// into the canvas runs its own effect pass, which cannot nest inside the one
+// active in video_render, so this runs from the video tick with the
+// graphics context held.
+static void flood_image_render(FloodImage *img) {
+    FloodAsset *asset = img->asset.get();
+    if (!asset)
+        return;
+
+    uint64_t time_ms = img->anim_pos_ms;
+    if (asset->type == FloodAsset::CUSTOM_WEBP && asset->webp_decoder) {
+        asset->webp_decoder->Render(time_ms, img->canvas);
+    } else if (asset->type == FloodAsset::CUSTOM_APNG && asset->apng_decoder) {
+        asset->apng_decoder->Render(time_ms, img->canvas);
+    } else if (asset->type == FloodAsset::CUSTOM_GIF && asset->gif_decoder) {
+        asset->gif_decoder->Render(time_ms, img->canvas);
+    }
+}
+
+static void flood_image_tick(FloodImage *img, uint64_t elapsed_ns, PlaybackMode mode, uint32_t loops) {
+    FloodAsset *asset = img->asset.get();
+    if (!asset)
+        return;
+
+    // Catch up on the time the slot spent hidden in one step
+    elapsed_ns += img->hidden_ns;
+    img->hidden_ns = 0;
+
+    // Streamed animations only decode forward, so ping-pong loops them instead
+    if (asset->type == FloodAsset::CUSTOM_WEBP) {
+        WebPDecoder *dec = asset->webp_decoder;
+        if (dec && dec->IsAnimated() &&
+            advance_playback(img, elapsed_ns, dec->GetDuration(), (uint32_t)dec->GetLoopCount(), mode, loops, !dec->IsStreaming())) {
+            dec->Tick(img->anim_pos_ms);
+        }
+    } else if (asset->type == FloodAsset::CUSTOM_APNG) {
+        APNGDecoder *dec = asset->apng_decoder;
+        if (dec && dec->IsAnimated() &&
+            advance_playback(img, elapsed_ns, dec->GetDuration(), dec->GetNumPlays(), mode, loops, !dec->IsStreaming())) {
+            dec->Tick(img->anim_pos_ms);
         }
-    } else if (img->type == FloodImage::CUSTOM_APNG) {
-        if (img->apng_decoder) {
-            img->anim_time_ns += elapsed_ns;
-            // Trace animation time occasionally (approx every 1s at 60fps)
-            static int log_counter = 0;
-            if (++log_counter > 60) {
-                 // BLOG(LOG_DEBUG, "APNG Tick: Time=%llu ms", img->anim_time_ns / 1000000);
-                 log_counter = 0;
-            }
+    } else if (asset->type == FloodAsset::CUSTOM_GIF) {
+        GIFDecoder *dec = asset->gif_decoder;
+        if (dec && dec->IsAnimated() &&
+            advance_playback(img, elapsed_ns, dec->GetDuration(), dec->GetNumPlays(), mode, loops, !dec->IsStreaming())) {
+            dec->Tick(img->anim_pos_ms);
         }
     } else {
-        gs_image_file_tick(&img->obs_image, elapsed_ns);
-        gs_image_file_update_texture(&img->obs_image);
+        gs_image_file_tick(&asset->obs_image, elapsed_ns);
+        gs_image_file_update_texture(&asset->obs_image);
+        return;
     }
+
+    // Also once playback has finished, so a restarted or new canvas shows
+    // the held frame
+    flood_image_render(img);
 }
 
 static gs_texture_t* flood_image_get_texture(FloodImage *img) {
-    if (img->type == FloodImage::CUSTOM_WEBP && img->webp_decoder) {
-        return img->webp_decoder->GetTextureForTime(img->anim_time_ns / 1000000ULL);
+    FloodAsset *asset = img->asset.get();
+    if (!asset)
+        return nullptr;
+
+    if (asset->type == FloodAsset::CUSTOM_WEBP && asset->webp_decoder) {
+        return asset->webp_decoder->GetTexture(img->canvas);
+    }
+    if (asset->type == FloodAsset::CUSTOM_APNG && asset->apng_decoder) {
+        return asset->apng_decoder->GetTexture(img->canvas);
     }
-    if (img->type == FloodImage::CUSTOM_APNG && img->apng_decoder) {
-        return img->apng_decoder->GetTextureForTime(img->anim_time_ns / 1000000ULL);
+    if (asset->type == FloodAsset::CUSTOM_GIF && asset->gif_decoder) {
+        return asset->gif_decoder->GetTexture(img->canvas);
     }
-    return img->obs_image.texture;
+    return asset->obs_image.texture;
 }
 
 static uint32_t flood_image_get_width(FloodImage *img) {
-    if (img->type == FloodImage::CUSTOM_WEBP && img->webp_decoder) {
-        return img->webp_decoder->GetWidth();
+    FloodAsset *asset = img->asset.get();
+    if (!asset)
+        return 0;
+
+    if (asset->type == FloodAsset::CUSTOM_WEBP && asset->webp_decoder) {
+        return asset->webp_decoder->GetWidth();
+    }
+    if (asset->type == FloodAsset::CUSTOM_APNG && asset->apng_decoder) {
+        return asset->apng_decoder->GetWidth();
     }
-    if (img->type == FloodImage::CUSTOM_APNG && img->apng_decoder) {
-        return img->apng_decoder->GetWidth();
+    if (asset->type == FloodAsset::CUSTOM_GIF && asset->gif_decoder) {
+        return asset->gif_decoder->GetWidth();
     }
-    return img->obs_image.cx;
+    return asset->full_cx ? asset->full_cx : asset->obs_image.cx;
 }
 
 static uint32_t flood_image_get_height(FloodImage *img) {
-    if (img->type == FloodImage::CUSTOM_WEBP && img->webp_decoder) {
-        return img->webp_decoder->GetHeight();
+    FloodAsset *asset = img->asset.get();
+    if (!asset)
+        return 0;
+
+    if (asset->type == FloodAsset::CUSTOM_WEBP && asset->webp_decoder) {
+        return asset->webp_decoder->GetHeight();
     }
-    if (img->type == FloodImage::CUSTOM_APNG && img->apng_decoder) {
-        return img->apng_decoder->GetHeight();
+    if (asset->type == FloodAsset::CUSTOM_APNG && asset->apng_decoder) {
+        return asset->apng_decoder->GetHeight();
     }
-    return img->obs_image.cy;
+    if (asset->type == FloodAsset::CUSTOM_GIF && asset->gif_decoder) {
+        return asset->gif_decoder->GetHeight();
+    }
+    return asset->full_cy ? asset->full_cy : asset->obs_image.cy;
+}
+
+
+// Builds the change-detection key for an image path
+static FloodFileKey make_file_key(const char *path, FloodMemoryPolicy policy, uint32_t max_dim)
+{
+	FloodFileKey key;
+	if (!path || !*path)
+		return key;
+
+	key.policy = policy;
+	key.max_dim = max_dim;
+	char *abs_path = os_get_abs_path_ptr(path);
+	key.path = abs_path ? abs_path : path;
+	bfree(abs_path);
+
+	struct stat st;
+	if (os_stat(key.path.c_str(), &st) == 0) {
+		key.size = (int64_t)st.st_size;
+#ifdef __linux__
+		// Sub-second precision, so two quick saves in an editor both reload
+		key.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+		key.mtime = (int64_t)st.st_mtime;
+#endif
+	}
+	return key;
+}
+
+// The "memory_policy" setting; unknown values fall back to resident
+static FloodMemoryPolicy get_memory_policy(obs_data_t *settings)
+{
+	const char *name = obs_data_get_string(settings, "memory_policy");
+	if (strcmp(name, "compressed") == 0)
+		return FloodMemoryPolicy::COMPRESSED;
+	if (strcmp(name, "streaming") == 0)
+		return FloodMemoryPolicy::STREAMING;
+	return FloodMemoryPolicy::RESIDENT;
+}
+
+// Starts decoding the image slots whose file changed since the last apply.
+// Unchanged slots keep their textures, so behaviour-only settings (timers,
+// threshold, motion) never touch the GPU. Every slot is a separate task on
+// the worker pool; slots of a superseded load that are still wanted are
+// adopted as-is instead of being decoded again. The current textures stay
+// on screen until finish_image_load() swaps in the new set.
+static void start_image_load(struct flood_tuber_data *data, obs_data_t *settings)
+{
+	FloodMemoryPolicy policy = get_memory_policy(settings);
+	uint32_t max_dim = (uint32_t)obs_data_get_int(settings, "max_texture_size");
+
+	FloodFileKey keys[IMAGE_SLOT_COUNT];
+	for (size_t i = 0; i < IMAGE_SLOT_COUNT; i++)
+		keys[i] = make_file_key(obs_data_get_string(settings, image_slots[i].setting), policy, max_dim);
+
+	std::vector<std::shared_ptr<FloodLoadEntry>> submit;
+	{
+		std::lock_guard<std::mutex> lock(data->load_mutex);
+
+		std::shared_ptr<FloodLoadEntry> in_flight[IMAGE_SLOT_COUNT];
+		if (data->pending_load) {
+			for (auto &entry : data->pending_load->entries)
+				in_flight[entry->slot] = entry;
+		}
+
+		auto job = std::make_shared<FloodLoadJob>();
+		job->start_ns = os_gettime_ns();
+		for (size_t i = 0; i < IMAGE_SLOT_COUNT; i++) {
+			if (keys[i] == data->slot_keys[i]) {
+				if (in_flight[i])
+					job->entries.push_back(std::move(in_flight[i]));
+				continue;
+			}
+
+			auto entry = std::make_shared<FloodLoadEntry>();
+			entry->slot = i;
+			entry->key = keys[i];
+			data->slot_keys[i] = keys[i];
+			job->entries.push_back(entry);
+			submit.push_back(std::move(entry));
+		}
+
+		// Whatever was not adopted is no longer needed
+		for (auto &entry : in_flight) {
+			if (entry)
+				entry->cancelled = true;
+		}
+
+		if (submit.empty() && !data->pending_load)
+			return;
+		data->pending_load = job->entries.empty() ? nullptr : job;
+	}
+
+	for (auto &entry : submit) {
+		WorkerPool::Get().Submit([entry]() {
+			if (!entry->cancelled)
+				load_image(&entry->image, entry->key, &entry->shared);
+			entry->done = true;
+		});
+	}
 }
 
+// Load telemetry summed over the first load of every source, i.e. what
+// Flood Tuber added to OBS startup
+static struct {
+	std::mutex mutex;
+	size_t sources = 0;
+	size_t images = 0;
+	size_t file_bytes = 0;
+	uint64_t decode_ns = 0;
+	uint64_t upload_ns = 0;
+	size_t ram_bytes = 0;
+	size_t vram_bytes = 0;
+} load_totals;
+
+static const char *file_name(const std::string &path)
+{
+	size_t sep = path.find_last_of("/\\");
+	return path.c_str() + (sep == std::string::npos ? 0 : sep + 1);
+}
+
+static double to_ms(uint64_t ns) { return (double)ns / 1000000.0; }
+static double to_kb(size_t bytes) { return (double)bytes / 1024.0; }
+static double to_mb(size_t bytes) { return (double)bytes / (1024.0 * 1024.0); }
+
+// Logs what one finished load cost, per slot and for the whole source.
+// Assets shared with another slot or source count toward the one that
+// decoded them, so totals count every file once.
+static void report_image_load(struct flood_tuber_data *data, const FloodLoadJob &job,
+	const std::vector<bool> &uploaded_here)
+{
+	const char *name = obs_source_get_name(data->source);
+	size_t images = 0, shared = 0, file_bytes = 0, ram_bytes = 0, vram_bytes = 0;
+	uint64_t decode_ns = 0, upload_ns = 0;
+
+	for (size_t i = 0; i < job.entries.size(); i++) {
+		const FloodLoadEntry &entry = *job.entries[i];
+		const FloodAsset *asset = (data->*image_slots[entry.slot].image).asset.get();
+		if (!asset)
+			continue;
+
+		const FloodAssetStats &st = asset->stats;
+		const char *slot = image_slots[entry.slot].setting;
+		images++;
+		if (uploaded_here[i])
+			upload_ns += st.upload_ns;
+
+		if (entry.shared) {
+			shared++;
+			BLOG(LOG_INFO, "'%s' %s: %s shared with a loaded image, %.1f MB VRAM",
+				name, slot, file_name(entry.key.path), to_mb(st.vram_bytes));
+			continue;
+		}
+
+		file_bytes += st.file_bytes;
+		decode_ns += st.decode_ns;
+		ram_bytes += st.ram_bytes;
+		vram_bytes += st.vram_bytes;
+		BLOG(LOG_INFO, "'%s' %s: %s (%s) %.1f KB read in %.1f ms, decode %.1f ms, "
+			"%zu frames, %.1f MB RAM, upload %.1f ms, %.1f MB VRAM",
+			name, slot, file_name(entry.key.path), st.format,
+			to_kb(st.file_bytes), to_ms(st.read_ns), to_ms(st.decode_ns),
+			asset->GetFrameCount(), to_mb(st.ram_bytes), to_ms(st.upload_ns),
+			to_mb(st.vram_bytes));
+	}
 
+	BLOG(LOG_INFO, "'%s' loaded %zu images (%zu shared) in %.1f ms: %.1f KB read, "
+		"decode %.1f ms total, upload %.1f ms, %.1f MB RAM, %.1f MB VRAM",
+		name, images, shared, to_ms(os_gettime_ns() - job.start_ns), to_kb(file_bytes),
+		to_ms(decode_ns), to_ms(upload_ns), to_mb(ram_bytes), to_mb(vram_bytes));
+
+	if (data->load_reported)
+		return;
+	data->load_reported = true;
+
+	std::lock_guard<std::mutex> lock(load_totals.mutex);
+	load_totals.sources++;
+	load_totals.images += images;
+	load_totals.file_bytes += file_bytes;
+	load_totals.decode_ns += decode_ns;
+	load_totals.upload_ns += upload_ns;
+	load_totals.ram_bytes += ram_bytes;
+	load_totals.vram_bytes += vram_bytes;
+	BLOG(LOG_INFO, "All sources so far: %zu sources, %zu images, %.1f KB read, "
+		"decode %.1f ms total, upload %.1f ms, %.1f MB RAM, %.1f MB VRAM",
+		load_totals.sources, load_totals.images, to_kb(load_totals.file_bytes),
+		to_ms(load_totals.decode_ns), to_ms(load_totals.upload_ns),
+		to_mb(load_totals.ram_bytes), to_mb(load_totals.vram_bytes));
+}
+
+// Uploads and swaps in a finished background load. Called from the video
+// tick; every slot of the load is uploaded in a single graphics section.
+static void finish_image_load(struct flood_tuber_data *data)
+{
+	std::shared_ptr<FloodLoadJob> job;
+	{
+		std::lock_guard<std::mutex> lock(data->load_mutex);
+		if (!data->pending_load || !data->pending_load->IsReady())
+			return;
+		job = std::move(data->pending_load);
+	}
+
+	std::vector<bool> uploaded_here(job->entries.size());
+	obs_enter_graphics();
+	for (size_t i = 0; i < job->entries.size(); i++) {
+		FloodLoadEntry &entry = *job->entries[i];
+		FloodAsset *asset = entry.image.asset.get();
+		uploaded_here[i] = asset && !asset->uploaded;
+		upload_image(&entry.image);
+		flood_image_render(&entry.image); // First frame, so the slot has a texture to select
+		std::swap(data->*image_slots[entry.slot].image, entry.image);
+		entry.image.Free(); // Previous image, now swapped out
+	}
+	obs_leave_graphics();
+
+	report_image_load(data, *job, uploaded_here);
+}
+
+// Decode settings a library is prewarmed with
+struct FloodPrewarmParams {
+	FloodMemoryPolicy policy;
+	uint32_t max_dim;
+};
+
+// Queues one library image for background decoding. `param` points at the
+// source's FloodPrewarmParams, so the prewarmed asset matches what the
+// source loads.
+static void prewarm_image(void *param, const char *path)
+{
+	FloodPrewarmParams params = *(const FloodPrewarmParams *)param;
+	std::string file = path;
+	WorkerPool::Get().Submit([file, params]() {
+		FloodFileKey key = make_file_key(file.c_str(), params.policy, params.max_dim);
+		AssetCache::Get().Prewarm(key, [&key](FloodAsset *asset, const std::vector<uint8_t> &file) {
+			decode_image(asset, key.path.c_str(), file, key.policy, key.max_dim);
+		});
+	}, true);
+}
+
+// Opt-in: decodes every avatar in the library dropdown in the background,
+// so "Load & Apply" only has to upload textures. Re-queued only when the
+// prewarm settings or the custom folder change.
+static void update_prewarm(struct flood_tuber_data *data, obs_data_t *settings)
+{
+	bool enabled = obs_data_get_bool(settings, "prewarm_library");
+	size_t budget = enabled ? (size_t)obs_data_get_int(settings, "prewarm_budget_mb") * 1024 * 1024 : 0;
+	const char *custom = obs_data_get_string(settings, "custom_avatars_path");
+	uint32_t max_dim = (uint32_t)obs_data_get_int(settings, "max_texture_size");
+	FloodMemoryPolicy policy = get_memory_policy(settings);
+
+	if (enabled == data->prewarm_enabled && budget == data->prewarm_budget &&
+	    data->prewarm_custom_path == custom && max_dim == data->prewarm_max_dim &&
+	    policy == data->prewarm_policy)
+		return;
+
+	// The budget is shared by all sources; a source that never opted in
+	// leaves it alone
+	if (enabled || data->prewarm_enabled)
+		AssetCache::Get().SetPrewarmBudget(budget);
+
+	data->prewarm_enabled = enabled;
+	data->prewarm_budget = budget;
+	data->prewarm_custom_path = custom;
+	data->prewarm_max_dim = max_dim;
+	data->prewarm_policy = policy;
+
+	if (enabled) {
+		FloodPrewarmParams params = {policy, max_dim};
+		enum_library_images(settings, prewarm_image, &params);
+	}
+}
+
+// Called by the file watcher once edits to a slot's file have settled.
+// Re-running the load re-stats every slot, so only files whose size or mtime
+// changed are decoded again, off the graphics thread as usual.
+static void reload_changed_images(struct flood_tuber_data *data)
+{
+	obs_data_t *settings = obs_source_get_settings(data->source);
+	if (!settings)
+		return;
+	start_image_load(data, settings);
+	obs_data_release(settings);
+}
+
+// Opt-in: watches the files of every slot (for library avatars, the folder
+// returned by resolve_avatar_dir()) and reloads them when they change
+static void update_hot_reload(struct flood_tuber_data *data, obs_data_t *settings)
+{
+	if (!obs_data_get_bool(settings, "hot_reload")) {
+		data->watcher.reset();
+		return;
+	}
+
+	if (!data->watcher)
+		data->watcher.reset(new FileWatcher([data]() { reload_changed_images(data); }));
+
+	std::vector<std::string> files;
+	{
+		std::lock_guard<std::mutex> lock(data->load_mutex);
+		for (const auto &key : data->slot_keys) {
+			if (!key.path.empty())
+				files.push_back(key.path);
+		}
+	}
+	data->watcher->SetFiles(files);
+}
 
 // Callback: Processes audio data to calculate volume levels (dB)
 static void audio_callback(void *data_ptr, obs_source_t *source, const struct audio_data *audio_data, bool muted)
@@ -186,7 +682,7 @@ static void audio_callback(void *data_ptr, obs_source_t *source, const struct au
 // Plugin Init: Allocates memory and initializes the plugin state
 static void *flood_tuber_create(obs_data_t *settings, obs_source_t *source)
 {
-	struct flood_tuber_data *data = (struct flood_tuber_data *)bzalloc(sizeof(struct flood_tuber_data));
+	struct flood_tuber_data *data = new flood_tuber_data();
 	data->source = source;
 	data->current_db = -100.0f;
 	data->current_state = AvatarState::IDLE;
@@ -207,18 +703,24 @@ static void flood_tuber_destroy(void *d)
 		obs_source_remove_audio_capture_callback(data->audio_source, audio_callback, data);
 		obs_source_release(data->audio_source);
 	}
+
+	// Stop reload callbacks before tearing down the load state
+	data->watcher.reset();
+
+	{
+		std::lock_guard<std::mutex> lock(data->load_mutex);
+		if (data->pending_load) {
+			for (auto &entry : data->pending_load->entries)
+				entry->cancelled = true;
+		}
+		data->pending_load.reset();
+	}
+
 	obs_enter_graphics();
-	data->image_idle.Free();
-	data->image_blink.Free();
-	data->image_action.Free();
-	data->image_talking_1.Free();
-	data->image_talking_2.Free();
-	data->image_talking_3.Free();
-	data->image_talking_1_blink.Free();
-	data->image_talking_2_blink.Free();
-	data->image_talking_3_blink.Free();
+	for (size_t i = 0; i < IMAGE_SLOT_COUNT; i++)
+		(data->*image_slots[i].image).Free();
 	obs_leave_graphics();
-	bfree(data);
+	delete data;
 }
 
 
@@ -233,15 +735,9 @@ static void flood_tuber_update(void *data_ptr, obs_data_t *settings)
 		data->audio_source = NULL;
 	}
 
-	update_image(&data->image_idle, obs_data_get_string(settings, "path_idle"));
-	update_image(&data->image_blink, obs_data_get_string(settings, "path_blink"));
-	update_image(&data->image_action, obs_data_get_string(settings, "path_action"));
-	update_image(&data->image_talking_1, obs_data_get_string(settings, "path_talk_1"));
-	update_image(&data->image_talking_2, obs_data_get_string(settings, "path_talk_2"));
-	update_image(&data->image_talking_3, obs_data_get_string(settings, "path_talk_3"));
-	update_image(&data->image_talking_1_blink, obs_data_get_string(settings, "path_talk_1_blink"));
-	update_image(&data->image_talking_2_blink, obs_data_get_string(settings, "path_talk_2_blink"));
-	update_image(&data->image_talking_3_blink, obs_data_get_string(settings, "path_talk_3_blink"));
+	start_image_load(data, settings);
+	update_prewarm(data, settings);
+	update_hot_reload(data, settings);
 
 	data->threshold = (float)obs_data_get_double(settings, "threshold");
 	data->release_delay = (float)obs_data_get_int(settings, "release_delay") / 1000.0f; // ms to seconds
@@ -255,6 +751,19 @@ static void flood_tuber_update(void *data_ptr, obs_data_t *settings)
 	data->blink_interval_min = (float)obs_data_get_int(settings, "blink_interval_min") / 1000.0f;
 	data->blink_interval_max = (float)obs_data_get_int(settings, "blink_interval_max") / 1000.0f;
 	
+	const char *playback = obs_data_get_string(settings, "playback_mode");
+	if (strcmp(playback, "loop") == 0)
+		data->playback_mode = PlaybackMode::LOOP;
+	else if (strcmp(playback, "once") == 0)
+		data->playback_mode = PlaybackMode::ONCE;
+	else if (strcmp(playback, "loop_n") == 0)
+		data->playback_mode = PlaybackMode::LOOP_N;
+	else if (strcmp(playback, "ping_pong") == 0)
+		data->playback_mode = PlaybackMode::PING_PONG;
+	else
+		data->playback_mode = PlaybackMode::FILE;
+	data->playback_loops = (uint32_t)std::max(1LL, obs_data_get_int(settings, "playback_loops"));
+
 	const char *motion_type = obs_data_get_string(settings, "motion_type");
 	if (strcmp(motion_type, "Bounce") == 0)
 		data->talk_effect = TalkingEffect::BOUNCE;
@@ -280,29 +789,106 @@ static void flood_tuber_update(void *data_ptr, obs_data_t *settings)
 	data->time_until_next_blink = data->blink_interval_min;
 }
 
+// Picks the slot shown for a state (Talking, Idle, Blink, Action), falling
+// back to the closest slot that has an image
+static FloodImage *select_image(struct flood_tuber_data *data, AvatarState state, int talk_index, bool blink)
+{
+	if (state == AvatarState::ACTION && flood_image_get_texture(&data->image_action))
+		return &data->image_action;
+
+	if (state != AvatarState::TALKING) {
+		if (blink && flood_image_get_texture(&data->image_blink))
+			return &data->image_blink;
+		return &data->image_idle;
+	}
+
+	FloodImage *img = &data->image_idle;
+	int idx = talk_index;
+	FloodImage *talk_img = nullptr;
+	FloodImage *talk_blink_img = nullptr;
+
+	// Select based on index
+	if (idx == 0) {
+		talk_img = &data->image_talking_1;
+		talk_blink_img = &data->image_talking_1_blink;
+	} else if (idx == 1) {
+		talk_img = &data->image_talking_2;
+		talk_blink_img = &data->image_talking_2_blink;
+	} else {
+		talk_img = &data->image_talking_3;
+		talk_blink_img = &data->image_talking_3_blink;
+	}
+
+	// Fallbacks
+	if (!flood_image_get_texture(talk_img) && idx == 2) {
+		talk_img = &data->image_talking_2;
+		talk_blink_img = &data->image_talking_2_blink;
+		idx = 1;
+	}
+	if (!flood_image_get_texture(talk_img) && idx == 1) {
+		talk_img = &data->image_talking_1;
+		talk_blink_img = &data->image_talking_1_blink;
+	}
+
+	// Determine final texture
+	if (blink && talk_blink_img && flood_image_get_texture(talk_blink_img)) {
+		img = talk_blink_img;
+	} else if (talk_img && flood_image_get_texture(talk_img)) {
+		img = talk_img;
+	}
+
+	// Final fallback for blinking if specific talk-blink is missing
+	if (blink && (!talk_blink_img || !flood_image_get_texture(talk_blink_img)) && flood_image_get_texture(&data->image_blink)) {
+		img = &data->image_blink;
+	}
+	return img;
+}
+
+// How far ahead of a timed state change the slot it will show starts
+// ticking, so a streamed animation has its frames decoded by then
+#define PREFETCH_SECONDS 0.25f
+#define MAX_PREFETCH_IMAGES 3
+
+// Slots that a blink, action, talk frame or talk release is about to show.
+// Talking itself starts on audio and cannot be predicted.
+static size_t get_prefetch_images(struct flood_tuber_data *data, FloodImage **out)
+{
+	size_t count = 0;
+	AvatarState state = data->current_state;
+	int idx = data->talking_frame_index;
+	bool blink = data->is_blinking_now;
+
+	if (flood_image_get_texture(&data->image_blink)) {
+		float due = blink ? data->blink_duration : data->time_until_next_blink;
+		if (data->timer_blink + PREFETCH_SECONDS >= due)
+			out[count++] = select_image(data, state, idx, !blink);
+	}
+
+	if (state == AvatarState::TALKING) {
+		if (data->timer_talk_anim + PREFETCH_SECONDS > data->talk_interval)
+			out[count++] = select_image(data, state, (idx + 1) % 3, blink);
+		// The hold timer only runs once the audio went quiet
+		if (data->timer_release_hold > 0.0f && data->timer_release_hold + PREFETCH_SECONDS > data->release_delay)
+			out[count++] = select_image(data, AvatarState::IDLE, idx, blink);
+	} else {
+		float due = state == AvatarState::ACTION ? data->action_duration : data->time_until_next_action;
+		if (data->timer_action + PREFETCH_SECONDS >= due)
+			out[count++] = select_image(data, state == AvatarState::ACTION ? AvatarState::IDLE : AvatarState::ACTION,
+						    idx, blink);
+	}
+	return count;
+}
+
 // Main Tick: Handles state logic (Idle/Talking switching, timers for blinking and actions)
 static void flood_tuber_tick(void *data_ptr, float seconds)
 {
 	struct flood_tuber_data *data = (struct flood_tuber_data *)data_ptr;
 
-	// Tick animations for all images
 	// Convert seconds to nanoseconds for gs_image_file_tick
 	uint64_t elapsed_ns = (uint64_t)(seconds * 1000000000.0f);
 
-    obs_enter_graphics(); // Required for standard texture updates
-	
-    flood_image_tick(&data->image_idle, elapsed_ns);
-	flood_image_tick(&data->image_blink, elapsed_ns);
-	flood_image_tick(&data->image_action, elapsed_ns);
-	flood_image_tick(&data->image_talking_1, elapsed_ns);
-	flood_image_tick(&data->image_talking_2, elapsed_ns);
-	flood_image_tick(&data->image_talking_3, elapsed_ns);
-	flood_image_tick(&data->image_talking_1_blink, elapsed_ns);
-	flood_image_tick(&data->image_talking_2_blink, elapsed_ns);
-	flood_image_tick(&data->image_talking_3_blink, elapsed_ns);
-    
-    obs_leave_graphics();
-	
+	finish_image_load(data);
+
 	float magnitude = data->current_db;
 	bool raw_talking = (magnitude > data->threshold) && (magnitude > -95.0f);
 
@@ -383,75 +969,59 @@ static void flood_tuber_tick(void *data_ptr, float seconds)
 	} else {
 		data->timer_effect = 0.0f;
 	}
-}
 
-// Render: Selects and draws the correct texture based on current state (Talking, Idle, Blink, Action)
-static void flood_tuber_render(void *data_ptr, gs_effect_t *effect)
-{
-	struct flood_tuber_data *data = (struct flood_tuber_data *)data_ptr;
-	gs_texture_t *tex = flood_image_get_texture(&data->image_idle);
+	// Animations advance only in the slot on screen and the slots a timed
+	// change is about to show. Every other slot just banks the elapsed
+	// time, and resumes at the right frame once it is ticked again.
+	FloodImage *ticked[1 + MAX_PREFETCH_IMAGES];
+	ticked[0] = select_image(data, data->current_state, data->talking_frame_index, data->is_blinking_now);
+	size_t ticked_count = 1 + get_prefetch_images(data, ticked + 1);
 
-	if (data->current_state == AvatarState::ACTION && flood_image_get_texture(&data->image_action)) {
-		tex = flood_image_get_texture(&data->image_action);
-	} 
-	else if (data->current_state == AvatarState::TALKING) {
-		bool blink = data->is_blinking_now;
-		
-		int idx = data->talking_frame_index;
-		FloodImage *talk_img = nullptr;
-		FloodImage *talk_blink_img = nullptr;
-
-		// Select based on index
-		if (idx == 0) {
-			talk_img = &data->image_talking_1;
-			talk_blink_img = &data->image_talking_1_blink;
-		} else if (idx == 1) {
-			talk_img = &data->image_talking_2;
-			talk_blink_img = &data->image_talking_2_blink;
-		} else {
-			talk_img = &data->image_talking_3;
-			talk_blink_img = &data->image_talking_3_blink;
-		}
-
-		// Fallbacks
-		if (!flood_image_get_texture(talk_img) && idx == 2) {
-             talk_img = &data->image_talking_2;
-             talk_blink_img = &data->image_talking_2_blink;
-             idx = 1;
-        }
-		if (!flood_image_get_texture(talk_img) && idx == 1) {
-             talk_img = &data->image_talking_1;
-             talk_blink_img = &data->image_talking_1_blink;
-        }
+	// A finished animation (blink, action) plays again each time it is shown
+	if (ticked[0] != data->last_shown) {
+		if (ticked[0]->anim_finished)
+			ticked[0]->Restart();
+		data->last_shown = ticked[0];
+	}
 
-		// Determine final texture
-		if (blink && talk_blink_img && flood_image_get_texture(talk_blink_img)) {
-			tex = flood_image_get_texture(talk_blink_img);
-		} else if (talk_img && flood_image_get_texture(talk_img)) {
-			tex = flood_image_get_texture(talk_img);
+	obs_enter_graphics(); // Required for standard texture updates
+	for (const auto &slot : image_slots) {
+		FloodImage *img = &(data->*slot.image);
+		if (std::find(ticked, ticked + ticked_count, img) == ticked + ticked_count) {
+			img->hidden_ns += elapsed_ns;
+			continue;
 		}
 
-		// Final fallback for blinking if specific talk-blink is missing
-		if (blink && (!talk_blink_img || !flood_image_get_texture(talk_blink_img)) && flood_image_get_texture(&data->image_blink)) {
-			tex = flood_image_get_texture(&data->image_blink);
-		}
-	} 
-	else {
-		if (data->is_blinking_now && flood_image_get_texture(&data->image_blink)) {
-			tex = flood_image_get_texture(&data->image_blink);
-		} else {
-			tex = flood_image_get_texture(&data->image_idle);
-		}
+		// Idle and talking images stay up as long as the state lasts, so a
+		// finite mode would freeze them; only ping-pong applies there
+		PlaybackMode mode = data->playback_mode;
+		if (!slot.one_shot && mode != PlaybackMode::PING_PONG)
+			mode = PlaybackMode::LOOP;
+		flood_image_tick(img, elapsed_ns, mode, data->playback_loops);
 	}
+	obs_leave_graphics();
+}
+
+// Render: Selects and draws the correct texture based on current state (Talking, Idle, Blink, Action)
+static void flood_tuber_render(void *data_ptr, gs_effect_t *effect)
+{
+	struct flood_tuber_data *data = (struct flood_tuber_data *)data_ptr;
+	FloodImage *img = select_image(data, data->current_state, data->talking_frame_index, data->is_blinking_now);
 
+	// Animation frames were brought up to date in the tick
+	gs_texture_t *tex = flood_image_get_texture(img);
 	if (tex) {
 		gs_matrix_push();
 		gs_matrix_translate3f(data->offset_x, data->offset_y, 0.0f);
+		// Downscaled textures are stretched back to the image's full size,
+		// so the source keeps its size in the scene
+		uint32_t cx = flood_image_get_width(img);
+		uint32_t cy = flood_image_get_height(img);
 		if (data->mirror) {
-			gs_matrix_translate3f((float)gs_texture_get_width(tex), 0.0f, 0.0f);
+			gs_matrix_translate3f((float)cx, 0.0f, 0.0f);
 			gs_matrix_scale3f(-1.0f, 1.0f, 1.0f);
 		}
-		obs_source_draw(tex, 0, 0, 0, 0, false);
+		obs_source_draw(tex, 0, 0, cx, cy, false);
 		gs_matrix_pop();
 	}
 }
@@ -498,8 +1068,13 @@ bool obs_module_load(void)
 	flood_tuber_info.icon_type = OBS_ICON_TYPE_AUDIO_INPUT;
 
 	obs_register_source(&flood_tuber_info);
-	blog(LOG_INFO, "[Flood-Tuber] v" FLOOD_TUBER_VERSION " loaded. (Build: " __DATE__ " " __TIME__ ")");
+	blog(LOG_INFO, "[Flood-Tuber] v" FLOOD_TUBER_VERSION " loaded. (Build: " __DATE__ " " __TIME__ ", inflate: %s)",
+	     png_inflate_backend());
 	return true;
 }
 //.obs_module_unload
-void obs_module_unload(void) {}
+void obs_module_unload(void)
+{
+	WorkerPool::Get().Shutdown();
+	AssetCache::Get().SetPrewarmBudget(0);
+}
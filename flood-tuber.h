@@ -5,8 +5,13 @@
 #include <util/dstr.h>
 #include <graphics/image-file.h>
 #include <math.h>
-#include "webp-decoder.h"
-#include "apng-decoder.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "asset-cache.h"
+#include "file-watcher.h"
 
 // FLOOD_TUBER_VERSION is defined by CMake via target_compile_definitions
 #ifndef FLOOD_TUBER_VERSION
@@ -29,41 +34,71 @@ enum class TalkingEffect {
 	SHAKE       // Random jitter/vibration
 };
 
-// Wrapper for different image types (OBS standard or Custom)
+// How animated images play. Finite modes hold the last frame when done;
+// they apply to the blink and action slots only, idle and talking images
+// always keep moving.
+enum class PlaybackMode {
+	FILE,       // Loop count stored in the file (0 = forever)
+	LOOP,       // Loop forever
+	ONCE,       // Play once
+	LOOP_N,     // Play playback_loops times
+	PING_PONG   // Forward, then backward, forever (fully decoded animations only)
+};
+
+// One image slot of a source: a (possibly shared) decoded asset plus this
+// source's own playback position.
 struct FloodImage {
-    enum Type {
-        OBS_STANDARD, // Uses gs_image_file_t (GIF, JPEG, PNG, etc.)
-        CUSTOM_WEBP,  // Uses WebPDecoder
-        CUSTOM_APNG   // Uses APNGDecoder (Future)
-    } type;
-
-    // Standard OBS loader
-    gs_image_file_t obs_image;
-
-    // Custom decoders
-    WebPDecoder* webp_decoder = nullptr;
-    APNGDecoder* apng_decoder = nullptr;
-    
+    std::shared_ptr<FloodAsset> asset;
+
     // Animation state for custom decoders
-    uint64_t anim_time_ns = 0;
+    uint64_t anim_time_ns = 0;   // Playing time since the animation (re)started
+    uint64_t anim_pos_ms = 0;    // Position in the animation's timeline shown now
+    bool anim_finished = false;  // Played out and holding a frame; nothing to tick
+    uint64_t hidden_ns = 0;      // Time that passed while the slot was not ticked, applied on its next tick
+    DeltaCanvas canvas;          // This slot's frame of a resident animation; the asset may be shared
+
+    // Helper: Release this slot's reference (the asset frees itself once unused).
+    // Caller must hold the graphics context once the slot has been uploaded.
+    void Free() {
+        asset.reset();
+        canvas.Free();
+        Restart();
+    }
 
-    FloodImage() {
-        type = OBS_STANDARD;
-        gs_image_file_init(&obs_image, NULL);
+    void Restart() {
+        anim_time_ns = 0;
+        anim_pos_ms = 0;
+        anim_finished = false;
+        hidden_ns = 0;
     }
+};
 
-    // Helper: Free resources
-    void Free() {
-        if (webp_decoder) {
-            delete webp_decoder;
-            webp_decoder = nullptr;
-        }
-        if (apng_decoder) {
-            delete apng_decoder;
-            apng_decoder = nullptr;
+// Number of FloodImage slots in flood_tuber_data (see image_slots[] in flood-tuber.cpp)
+#define IMAGE_SLOT_COUNT 9
+
+// One image slot being decoded in the background. Each entry is its own
+// worker task, so all slots of an avatar decode in parallel.
+struct FloodLoadEntry {
+    size_t slot = 0;   // Index into the image slot table (flood-tuber.cpp)
+    FloodFileKey key;
+    FloodImage image;  // Decoded on a worker thread; no textures until uploaded
+    bool shared = false; // Asset came from the cache, nothing was decoded for it
+    std::atomic<bool> done{false};
+    std::atomic<bool> cancelled{false}; // No load wants this entry any more
+};
+
+// A set of slots loading asynchronously. flood_tuber_tick() uploads the
+// textures and swaps the whole set in once every entry is done, so the
+// previous images keep rendering until then.
+struct FloodLoadJob {
+    std::vector<std::shared_ptr<FloodLoadEntry>> entries;
+    uint64_t start_ns = 0; // When the load was requested, for telemetry
+
+    bool IsReady() const {
+        for (const auto& entry : entries) {
+            if (!entry->done) return false;
         }
-        gs_image_file_free(&obs_image);
-        type = OBS_STANDARD;
+        return true;
     }
 };
 
@@ -110,6 +145,28 @@ struct flood_tuber_data {
 
 	volatile float current_db; // Current audio level in decibels
 
+	// -- Async Loading --
+	std::mutex load_mutex;                      // Guards pending_load and slot_keys
+	std::shared_ptr<FloodLoadJob> pending_load; // Images decoding in the background
+	FloodFileKey slot_keys[IMAGE_SLOT_COUNT];   // File each slot shows, or will once pending_load lands
+
+	// -- Library Prewarm (last applied settings) --
+	bool prewarm_enabled;
+	size_t prewarm_budget;                      // Bytes
+	std::string prewarm_custom_path;
+	uint32_t prewarm_max_dim;                   // Texture size cap the library was prewarmed with
+	FloodMemoryPolicy prewarm_policy;           // Memory policy the library was prewarmed with
+
+	bool load_reported;                         // First load counted in the startup totals
+
+	// -- Hot Reload (opt-in) --
+	std::unique_ptr<FileWatcher> watcher;       // Re-decodes slots whose file changed on disk
+
+	// -- Animation Playback --
+	PlaybackMode playback_mode;
+	uint32_t playback_loops;   // Plays in LOOP_N mode
+	FloodImage *last_shown;    // Slot shown last; finished animations restart when shown again
+
 	// -- Motion Effects --
 	TalkingEffect talk_effect;
 	bool mirror;
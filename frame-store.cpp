@@ -0,0 +1,159 @@
+#include "frame-store.h"
+
+#define BLOG(level, format, ...) blog(level, "[Frame-Store] " format, ##__VA_ARGS__)
+
+FrameStore::~FrameStore() {
+    Clear();
+}
+
+void FrameStore::Clear() {
+    if (still_texture) {
+        obs_enter_graphics();
+        gs_texture_destroy(still_texture);
+        obs_leave_graphics();
+        still_texture = nullptr;
+    }
+    std::vector<uint8_t>().swap(still_pixels);
+    std::vector<uint8_t>().swap(scaled);
+    scaler.reset();
+    deltas.reset();
+    compressed.reset();
+    compressed_durations.clear();
+    stream.reset();
+    timeline.Clear();
+    width = height = 0;
+    texture_width = texture_height = 0;
+}
+
+bool FrameStore::Begin(uint32_t width, uint32_t height, size_t frame_count, FrameStorage storage,
+                       uint32_t max_dim) {
+    Clear();
+    this->width = texture_width = width;
+    this->height = texture_height = height;
+
+    // Frames are composited at full size, then downscaled
+    if (Downscaler::Fit(width, height, max_dim, texture_width, texture_height)) {
+        scaler.reset(new Downscaler(width, height, texture_width, texture_height));
+        scaled.resize((size_t)texture_width * texture_height * 4);
+    }
+
+    // A FrameStream only pays off once the animation has more frames than
+    // the stream keeps in flight
+    bool use_stream = storage != FrameStorage::RESIDENT &&
+                      frame_count > FrameStream::RING_SIZE + FrameStream::LOOKAHEAD;
+    if (use_stream && storage == FrameStorage::STREAMING) return true;
+
+    // Animations keep only what changes between frames, compressed in RAM
+    // or as rectangles in VRAM
+    if (use_stream)
+        compressed.reset(new CompressedFrames(texture_width, texture_height));
+    else if (frame_count > 1)
+        deltas.reset(new DeltaFrames(texture_width, texture_height));
+    return false;
+}
+
+void FrameStore::Add(const uint8_t* canvas, uint32_t delay_ms) {
+    if (scaler) {
+        scaler->Run(canvas, scaled.data());
+        canvas = scaled.data();
+    }
+
+    // A held frame just extends the one before it
+    if (compressed) {
+        if (compressed->Add(canvas))
+            compressed_durations.push_back(delay_ms);
+        else
+            compressed_durations.back() += delay_ms;
+        return;
+    }
+    if (deltas) {
+        if (deltas->Add(canvas))
+            timeline.Add(delay_ms);
+        else
+            timeline.Extend(delay_ms);
+        return;
+    }
+    still_pixels.assign(canvas, canvas + (size_t)texture_width * texture_height * 4);
+}
+
+void FrameStore::AddStill(std::vector<uint8_t>&& pixels, uint32_t texture_width, uint32_t texture_height) {
+    this->texture_width = texture_width;
+    this->texture_height = texture_height;
+    still_pixels = std::move(pixels);
+}
+
+void FrameStore::Stream(std::unique_ptr<FrameProducer> producer, const std::vector<uint32_t>& durations_ms) {
+    if (scaler) {
+        producer.reset(new ScaledProducer(std::move(producer), width, height, texture_width, texture_height));
+    }
+    stream.reset(new FrameStream(std::move(producer), texture_width, texture_height, durations_ms));
+}
+
+bool FrameStore::Finish() {
+    scaler.reset();
+    std::vector<uint8_t>().swap(scaled);
+
+    if (compressed) {
+        if (compressed_durations.empty()) return false;
+        BLOG(LOG_INFO, "Compressed %zu frames into %.1f KB of RAM (%.1f KB raw)",
+             compressed->GetFrameCount(), compressed->GetCompressedSize() / 1024.0,
+             compressed->GetFrameCount() * (double)texture_width * texture_height * 4 / 1024.0);
+        stream.reset(new FrameStream(std::move(compressed), texture_width, texture_height, compressed_durations));
+        compressed_durations.clear();
+    }
+
+    if (deltas && (deltas->GetMergedFrames() || deltas->GetReusedRects())) {
+        BLOG(LOG_INFO, "Deduplicated frames: %zu held frames merged, %zu rectangles reused, %.1f KB saved",
+             deltas->GetMergedFrames(), deltas->GetReusedRects(), deltas->GetSavedBytes() / 1024.0);
+    }
+    return GetFrameCount() > 0;
+}
+
+bool FrameStore::Upload() {
+    if (stream) return stream->Upload();
+    if (deltas) return deltas->Upload();
+    if (still_texture) return true;
+    if (still_pixels.empty()) return false;
+
+    // A still image never changes after upload, so no dynamic (CPU-writable) texture
+    const uint8_t* data_ptr = still_pixels.data();
+    still_texture = gs_texture_create(texture_width, texture_height, GS_RGBA, 1, &data_ptr, 0);
+    if (!still_texture) {
+        BLOG(LOG_WARNING, "Failed to create texture for image");
+        return false;
+    }
+    std::vector<uint8_t>().swap(still_pixels); // GPU owns it now
+    return true;
+}
+
+void FrameStore::Tick(uint64_t time_ms) {
+    if (stream) stream->Update(time_ms);
+}
+
+void FrameStore::Render(uint64_t time_ms, DeltaCanvas& canvas) const {
+    if (deltas) deltas->Render(canvas, timeline.IndexForTime(time_ms));
+}
+
+gs_texture_t* FrameStore::GetTexture(const DeltaCanvas& canvas) const {
+    if (stream) return stream->GetTexture();
+    if (deltas) return canvas.texture;
+    return still_texture;
+}
+
+size_t FrameStore::GetFrameCount() const {
+    if (stream) return stream->GetFrameCount();
+    if (deltas) return deltas->GetFrameCount();
+    return still_texture || !still_pixels.empty() ? 1 : 0;
+}
+
+size_t FrameStore::GetRamSize() const {
+    if (stream) return stream->GetRamSize();
+    if (deltas) return deltas->GetRamSize();
+    return still_pixels.size();
+}
+
+size_t FrameStore::GetVramSize() const {
+    if (stream) return stream->GetVramSize();
+    if (deltas) return deltas->GetVramSize();
+    return GetFrameCount() * (size_t)texture_width * texture_height * 4;
+}
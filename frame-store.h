@@ -0,0 +1,88 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+#include <memory>
+#include <vector>
+#include "frame-stream.h"
+#include "delta-frames.h"
+#include "frame-timeline.h"
+#include "compressed-frames.h"
+
+// Decoded frames of one image, shared by the APNG, WebP and GIF decoders.
+// A decoder only composites canvases; the store downscales them to the
+// texture size cap and keeps them according to FrameStorage:
+//   - still images: one texture
+//   - resident animations: DeltaFrames (changed rectangles, held frames
+//     merged) with a FrameTimeline for lookup
+//   - compressed animations: CompressedFrames played through a FrameStream
+//   - streamed animations: the decoder's own FrameProducer, through a
+//     FrameStream
+class FrameStore {
+public:
+    FrameStore() = default;
+    ~FrameStore();
+
+    // Sets up for an image of `frame_count` canvases, `width` x `height`,
+    // stored downscaled to fit `max_dim` (0 = no limit). Returns true if
+    // the frames should be streamed: the caller then hands a producer to
+    // Stream() instead of calling Add().
+    bool Begin(uint32_t width, uint32_t height, size_t frame_count, FrameStorage storage, uint32_t max_dim);
+
+    // Appends the next full-size RGBA canvas, shown for `delay_ms`
+    void Add(const uint8_t* canvas, uint32_t delay_ms);
+
+    // Stores a still image already decoded at texture size
+    void AddStill(std::vector<uint8_t>&& pixels, uint32_t texture_width, uint32_t texture_height);
+
+    // Plays a streamed animation from `producer`, which hands out full-size
+    // canvases; `durations_ms` has one entry per frame
+    void Stream(std::unique_ptr<FrameProducer> producer, const std::vector<uint32_t>& durations_ms);
+
+    // Ends loading. Returns false if nothing was stored.
+    bool Finish();
+
+    // Creates the textures. Caller must hold the graphics context.
+    bool Upload();
+    void Clear();
+
+    // Advances streaming playback. Called from the video tick with the
+    // graphics context held; does nothing for fully decoded images.
+    void Tick(uint64_t time_ms);
+    // Rebuilds the frame for `time_ms` into the viewer's `canvas` (resident
+    // animations only). Called from the video tick with the graphics
+    // context held, never from video_render.
+    void Render(uint64_t time_ms, DeltaCanvas& canvas) const;
+    gs_texture_t* GetTexture(const DeltaCanvas& canvas) const;
+
+    bool IsStreaming() const { return stream != nullptr; } // Streamed or compressed, played through a FrameStream
+    size_t GetFrameCount() const;
+    uint64_t GetDuration() const { return stream ? stream->GetDuration() : timeline.GetDuration(); } // One loop, in ms
+    // RAM held now: pixels waiting for Upload(), then what playback keeps
+    // (compressed frames, the file copy and the stream's decoded frames)
+    size_t GetRamSize() const;
+    // Textures, once uploaded
+    size_t GetVramSize() const;
+
+    FrameStore(const FrameStore&) = delete;
+    FrameStore& operator=(const FrameStore&) = delete;
+
+private:
+    uint32_t width = 0;          // Size of the canvases passed to Add()
+    uint32_t height = 0;
+    uint32_t texture_width = 0;  // Size of the stored frames, smaller than
+    uint32_t texture_height = 0; // width x height when capped
+    std::unique_ptr<Downscaler> scaler;
+    std::vector<uint8_t> scaled; // Add() canvas at texture size
+
+    // Still image
+    std::vector<uint8_t> still_pixels; // Released after Upload()
+    gs_texture_t* still_texture = nullptr;
+
+    std::unique_ptr<DeltaFrames> deltas;
+    FrameTimeline timeline; // Frame lookup by time, for deltas
+
+    std::unique_ptr<CompressedFrames> compressed; // Filled by Add(), becomes a stream in Finish()
+    std::vector<uint32_t> compressed_durations;
+    std::unique_ptr<FrameStream> stream;
+};
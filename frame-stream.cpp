@@ -0,0 +1,170 @@
+#include "frame-stream.h"
+#include "worker-pool.h"
+
+#define BLOG(level, format, ...) blog(level, "[Frame-Stream] " format, ##__VA_ARGS__)
+
+FrameStream::FrameStream(std::unique_ptr<FrameProducer> producer, uint32_t width, uint32_t height,
+                         const std::vector<uint32_t>& durations_ms)
+    : shared(std::make_shared<Shared>()), width(width), height(height) {
+    for (uint32_t d : durations_ms)
+        timeline.Add(d);
+
+    shared->producer = std::move(producer);
+    shared->frame_count = durations_ms.size();
+    shared->busy = true;
+    Produce(shared);
+}
+
+FrameStream::~FrameStream() {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->cancelled = true;
+    }
+
+    obs_enter_graphics();
+    for (auto& tex : ring) {
+        if (tex) gs_texture_destroy(tex);
+        tex = nullptr;
+    }
+    obs_leave_graphics();
+}
+
+bool FrameStream::Upload() {
+    for (auto& tex : ring) {
+        if (tex) continue;
+        tex = gs_texture_create(width, height, GS_RGBA, 1, nullptr, GS_DYNAMIC);
+        if (!tex) {
+            BLOG(LOG_WARNING, "Failed to create streaming texture");
+            return false;
+        }
+    }
+    Update(0);
+    return current != nullptr;
+}
+
+// Sequence number of the frame on screen at `time_ms`. It keeps counting
+// across loops, so "older than the playhead" needs no wrap-around logic.
+uint64_t FrameStream::SequenceForTime(uint64_t time_ms) const {
+    return timeline.LoopForTime(time_ms) * timeline.GetFrameCount() + timeline.IndexForTime(time_ms);
+}
+
+void FrameStream::Update(uint64_t time_ms) {
+    if (!ring[0]) return;
+
+    uint64_t wanted = SequenceForTime(time_ms);
+    if (wanted == shown_seq) {
+        Schedule();
+        return;
+    }
+
+    std::vector<uint8_t> pixels;
+    uint64_t seq = 0;
+    bool have = false;
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+
+        // The playhead moved back (restarted animation), or ran a whole loop
+        // or more ahead of the decoder (hidden slot catching up): decode from
+        // the start of the playhead's loop instead of every frame in between
+        uint64_t next_seq = shared->restart ? shared->restart_seq : shared->produced_seq;
+        if (wanted < shared->wanted_seq || wanted >= next_seq + shared->frame_count) {
+            for (auto& r : shared->ready)
+                shared->spare.push_back(std::move(r.second));
+            shared->ready.clear();
+            shared->restart = true;
+            shared->restart_seq = wanted - wanted % shared->frame_count;
+        }
+        shared->wanted_seq = wanted;
+
+        // Newest decoded frame that is not ahead of the playhead. If the
+        // decoder fell behind, the last frame shown simply stays up.
+        while (!shared->ready.empty() && shared->ready.front().first <= wanted) {
+            if (have) shared->spare.push_back(std::move(pixels));
+            seq = shared->ready.front().first;
+            pixels = std::move(shared->ready.front().second);
+            shared->ready.pop_front();
+            have = true;
+        }
+    }
+
+    if (have) {
+        // Write into the oldest ring texture, never the one on screen
+        gs_texture_t* tex = ring[ring_next];
+        ring_next = (ring_next + 1) % RING_SIZE;
+        gs_texture_set_image(tex, pixels.data(), width * 4, false);
+        current = tex;
+        shown_seq = seq;
+
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->spare.push_back(std::move(pixels));
+    }
+    Schedule();
+}
+
+// Queues a decode task if the lookahead has room and none is running
+void FrameStream::Schedule() {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (shared->busy || shared->cancelled || shared->failed) return;
+        if (!shared->restart && shared->ready.size() >= LOOKAHEAD) return;
+        shared->busy = true;
+    }
+
+    std::shared_ptr<Shared> s = shared;
+    WorkerPool::Get().Submit([s]() { Produce(s); });
+}
+
+// Decodes frames in order until LOOKAHEAD of them wait at or after the
+// playhead. Frames the playhead already passed are composited (later
+// frames build on them) but not kept.
+void FrameStream::Produce(const std::shared_ptr<Shared>& s) {
+    for (;;) {
+        std::vector<uint8_t> canvas;
+        uint64_t seq;
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            if (s->restart) {
+                s->producer->Rewind();
+                s->produced_seq = s->restart_seq;
+                s->restart = false;
+            }
+            if (s->cancelled || s->ready.size() >= LOOKAHEAD) {
+                s->busy = false;
+                return;
+            }
+            seq = s->produced_seq;
+            if (!s->spare.empty()) {
+                canvas = std::move(s->spare.back());
+                s->spare.pop_back();
+            }
+        }
+
+        bool ok = s->producer->Next(canvas);
+
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (!ok) {
+            BLOG(LOG_WARNING, "Failed to decode frame, stopping stream");
+            s->failed = true;
+            s->busy = false;
+            return;
+        }
+        if (s->restart) {
+            s->spare.push_back(std::move(canvas));
+            continue;
+        }
+
+        s->produced_seq = seq + 1;
+        if (seq >= s->wanted_seq)
+            s->ready.emplace_back(seq, std::move(canvas));
+        else
+            s->spare.push_back(std::move(canvas));
+    }
+}
+
+size_t FrameStream::GetRamSize() const {
+    return LOOKAHEAD * (size_t)width * height * 4 + shared->producer->GetMemorySize();
+}
+
+size_t FrameStream::GetVramSize() const {
+    return RING_SIZE * (size_t)width * height * 4;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/graphics.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "frame-timeline.h"
+#include "downscale.h"
+
+// Where an animation's frames live between load and playback. RESIDENT
+// uploads every frame at load; COMPRESSED keeps them LZ4-compressed in RAM
+// and STREAMING keeps only the file, both playing through a FrameStream.
+enum class FrameStorage {
+    RESIDENT,
+    COMPRESSED,
+    STREAMING
+};
+
+// Produces the full-canvas RGBA frames of an animation in playback order,
+// decoding from the compressed file it keeps in memory. Implemented by the
+// APNG and WebP decoders.
+class FrameProducer {
+public:
+    virtual ~FrameProducer() = default;
+
+    // Composites the next frame into `canvas` (resized to width * height * 4),
+    // wrapping to the first frame after the last. Runs on a worker thread.
+    virtual bool Next(std::vector<uint8_t>& canvas) = 0;
+
+    // Restarts at the first frame
+    virtual void Rewind() = 0;
+
+    // RAM held by the producer (file copy, compressed frames)
+    virtual size_t GetMemorySize() const { return 0; }
+};
+
+// Hands out another producer's frames downscaled to the capped texture size
+class ScaledProducer : public FrameProducer {
+public:
+    ScaledProducer(std::unique_ptr<FrameProducer> source, uint32_t src_width, uint32_t src_height,
+                   uint32_t width, uint32_t height)
+        : source(std::move(source)), scaler(src_width, src_height, width, height), width(width), height(height),
+          full_size((size_t)src_width * src_height * 4) {}
+
+    bool Next(std::vector<uint8_t>& canvas) override {
+        if (!source->Next(full)) return false;
+        canvas.resize((size_t)width * height * 4);
+        scaler.Run(full.data(), canvas.data());
+        return true;
+    }
+    void Rewind() override { source->Rewind(); }
+    size_t GetMemorySize() const override { return source->GetMemorySize() + full_size; }
+
+private:
+    std::unique_ptr<FrameProducer> source;
+    Downscaler scaler;
+    uint32_t width, height;
+    size_t full_size;
+    std::vector<uint8_t> full; // Source canvas, reused between frames
+};
+
+// Streaming playback for long animations: instead of one texture per frame,
+// a worker decodes a few frames ahead of the playhead and the video tick
+// uploads them into a small ring of dynamic textures. VRAM stays at
+// RING_SIZE canvases and RAM at the compressed file plus LOOKAHEAD
+// canvases, however long the animation is.
+class FrameStream {
+public:
+    static const size_t RING_SIZE = 3;
+    static const size_t LOOKAHEAD = 4;
+
+    // `durations_ms` has one entry per frame. Decodes the first frames right
+    // away (call off the graphics thread), so the first Upload() has
+    // something to show.
+    FrameStream(std::unique_ptr<FrameProducer> producer, uint32_t width, uint32_t height,
+                const std::vector<uint32_t>& durations_ms);
+    ~FrameStream();
+
+    // Creates the texture ring. Caller must hold the graphics context.
+    bool Upload();
+
+    // Shows the frame for `time_ms`, uploading it if it is ready, and queues
+    // decoding ahead. Called from the video tick with the graphics context.
+    void Update(uint64_t time_ms);
+
+    gs_texture_t* GetTexture() const { return current; }
+    size_t GetFrameCount() const { return timeline.GetFrameCount(); }
+    uint64_t GetDuration() const { return timeline.GetDuration(); }
+
+    // Decoded frames waiting to be shown and the producer
+    size_t GetRamSize() const;
+    // Texture ring
+    size_t GetVramSize() const;
+
+    FrameStream(const FrameStream&) = delete;
+    FrameStream& operator=(const FrameStream&) = delete;
+
+private:
+    // State shared with the decode task, which may outlive the stream
+    struct Shared {
+        std::mutex mutex;
+        std::unique_ptr<FrameProducer> producer; // Used by one task at a time
+        size_t frame_count = 0;
+
+        // Decoded frames by playback sequence number (loop * frame_count + index)
+        std::deque<std::pair<uint64_t, std::vector<uint8_t>>> ready;
+        std::vector<std::vector<uint8_t>> spare; // Recycled canvases
+
+        uint64_t produced_seq = 0; // Sequence number the producer outputs next
+        uint64_t wanted_seq = 0;   // Playhead; older frames are not queued
+        uint64_t restart_seq = 0;  // Where to restart after the playhead jumped
+        bool restart = false;
+        bool busy = false;         // A decode task is queued or running
+        bool cancelled = false;
+        bool failed = false;
+    };
+
+    static void Produce(const std::shared_ptr<Shared>& shared);
+    void Schedule();
+    uint64_t SequenceForTime(uint64_t time_ms) const;
+
+    std::shared_ptr<Shared> shared;
+    uint32_t width;
+    uint32_t height;
+    FrameTimeline timeline;
+
+    gs_texture_t* ring[RING_SIZE] = {};
+    size_t ring_next = 0;
+    gs_texture_t* current = nullptr;
+    uint64_t shown_seq = UINT64_MAX;
+};
@@ -0,0 +1,38 @@
+#include "frame-timeline.h"
+#include <algorithm>
+
+void FrameTimeline::Clear() {
+    ends.clear();
+    cursor = 0;
+}
+
+void FrameTimeline::Add(uint32_t duration_ms) {
+    ends.push_back(GetDuration() + duration_ms);
+}
+
+void FrameTimeline::Extend(uint32_t duration_ms) {
+    if (ends.empty()) return;
+    ends.back() += duration_ms;
+}
+
+size_t FrameTimeline::IndexForTime(uint64_t time_ms) const {
+    uint64_t total = GetDuration();
+    if (ends.size() <= 1 || total == 0) return 0;
+    uint64_t t = time_ms % total;
+
+    // Still on the cached frame, or on the one right after it
+    uint64_t start = cursor > 0 ? ends[cursor - 1] : 0;
+    if (t >= start && t < ends[cursor]) return cursor;
+    size_t next = cursor + 1 < ends.size() ? cursor + 1 : 0;
+    start = next > 0 ? ends[next - 1] : 0;
+    if (t >= start && t < ends[next]) return cursor = next;
+
+    // First frame that ends after t
+    cursor = std::upper_bound(ends.begin(), ends.end(), t) - ends.begin();
+    return cursor;
+}
+
+uint64_t FrameTimeline::LoopForTime(uint64_t time_ms) const {
+    uint64_t total = GetDuration();
+    return total ? time_ms / total : 0;
+}
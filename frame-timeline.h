@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Maps a looping playback time to a frame index. Keeps the cumulative end
+// time of every frame, so a lookup is a binary search; the last result is
+// cached, so playing forward (same frame, or the next one) is O(1).
+class FrameTimeline {
+public:
+    void Clear();
+
+    // Appends a frame shown for `duration_ms`
+    void Add(uint32_t duration_ms);
+
+    // Lengthens the last frame, for held frames merged into it
+    void Extend(uint32_t duration_ms);
+
+    // Frame shown at `time_ms`, wrapping around at the end. Frames with no
+    // duration are never returned unless all of them have none.
+    size_t IndexForTime(uint64_t time_ms) const;
+
+    // Loop number of `time_ms` (0 for the first pass)
+    uint64_t LoopForTime(uint64_t time_ms) const;
+
+    uint64_t GetDuration() const { return ends.empty() ? 0 : ends.back(); }
+    size_t GetFrameCount() const { return ends.size(); }
+
+private:
+    std::vector<uint64_t> ends; // Cumulative end time of each frame
+    mutable size_t cursor = 0;  // Result of the last lookup
+};
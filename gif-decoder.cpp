@@ -0,0 +1,326 @@
+#include "gif-decoder.h"
+#include <obs-module.h>
+#include <algorithm>
+#include <memory>
+#include <string.h>
+
+#define BLOG(level, format, ...) blog(level, "[GIF-Decoder] " format, ##__VA_ARGS__)
+
+// GIF integers are little-endian
+static uint16_t read_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+// Skips a chain of length-prefixed sub-blocks up to and including the
+// terminator. Returns false if the file ends first.
+static bool skip_sub_blocks(const uint8_t* data, size_t size, size_t& pos) {
+    while (pos < size) {
+        uint8_t len = data[pos++];
+        if (len == 0) return true;
+        pos += len;
+    }
+    pos = size;
+    return false;
+}
+
+// Decodes a GIF LZW stream into `out`. Returns the number of indices
+// written; corrupt or truncated data just ends the frame early, the way
+// browsers show it.
+static size_t lzw_decode(const uint8_t* in, size_t in_size, uint8_t min_code_size, uint8_t* out, size_t out_size) {
+    if (min_code_size < 2 || min_code_size > 11) return 0;
+
+    const uint32_t MAX_CODES = 4096;
+    uint16_t prefix[MAX_CODES];
+    uint8_t suffix[MAX_CODES];
+    uint8_t first[MAX_CODES];  // First index of each string
+    uint16_t length[MAX_CODES];
+
+    const uint32_t clear = 1u << min_code_size;
+    const uint32_t end = clear + 1;
+    for (uint32_t i = 0; i < clear; i++) {
+        prefix[i] = 0;
+        suffix[i] = first[i] = (uint8_t)i;
+        length[i] = 1;
+    }
+
+    uint32_t next = clear + 2;
+    uint32_t code_size = min_code_size + 1;
+    int32_t prev = -1;
+    uint32_t bits = 0;
+    uint32_t bit_count = 0;
+    size_t pos = 0;
+    size_t written = 0;
+
+    while (written < out_size) {
+        while (bit_count < code_size) {
+            if (pos >= in_size) return written;
+            bits |= (uint32_t)in[pos++] << bit_count;
+            bit_count += 8;
+        }
+        uint32_t code = bits & ((1u << code_size) - 1);
+        bits >>= code_size;
+        bit_count -= code_size;
+
+        if (code == clear) {
+            next = clear + 2;
+            code_size = min_code_size + 1;
+            prev = -1;
+            continue;
+        }
+        if (code == end) break;
+
+        if (prev < 0) {
+            if (code >= clear) return written;
+        } else {
+            if (code > next) return written;
+            if (next < MAX_CODES) {
+                // code == next is the string being defined right now (KwKwK)
+                prefix[next] = (uint16_t)prev;
+                suffix[next] = code < next ? first[code] : first[prev];
+                first[next] = first[prev];
+                length[next] = length[prev] + 1;
+                next++;
+                if (next == (1u << code_size) && code_size < 12) code_size++;
+            } else if (code == next) {
+                return written;
+            }
+        }
+
+        // Strings are linked back to front
+        uint32_t len = length[code];
+        uint32_t c = code;
+        for (size_t i = written + len; i-- > written;) {
+            if (i < out_size) out[i] = suffix[c];
+            c = prefix[c];
+        }
+        written = std::min(written + len, out_size);
+        prev = (int32_t)code;
+    }
+    return written;
+}
+
+bool GIFCompositor::Parse(std::vector<uint8_t>&& data) {
+    file = std::move(data);
+    return Parse(file.data(), file.size());
+}
+
+bool GIFCompositor::Parse(const uint8_t* data, size_t size) {
+    infos.clear();
+    delays.clear();
+    num_plays = 0; // Without a NETSCAPE loop extension loop forever, as OBS's own GIF playback does
+
+    // Header and Logical Screen Descriptor
+    if (size < 13 || memcmp(data, "GIF8", 4) != 0) return false;
+    width = read_u16(data + 6);
+    height = read_u16(data + 8);
+    if (width == 0 || height == 0 || width > 16384 || height > 16384) return false;
+
+    const uint8_t screen_flags = data[10];
+    size_t pos = 13;
+    const uint8_t* global_palette = nullptr;
+    size_t global_size = 0;
+    if (screen_flags & 0x80) {
+        global_size = (size_t)2 << (screen_flags & 7);
+        if (pos + global_size * 3 > size) return false;
+        global_palette = data + pos;
+        pos += global_size * 3;
+    }
+
+    GIFFrameInfo control; // Graphic Control Extension for the next image
+    while (pos < size) {
+        const uint8_t introducer = data[pos++];
+        if (introducer == 0x3B) break; // Trailer
+
+        if (introducer == 0x21) { // Extension
+            if (pos >= size) break;
+            const uint8_t label = data[pos++];
+            if (label == 0xF9 && pos + 5 <= size && data[pos] >= 4) {
+                const uint8_t flags = data[pos + 1];
+                const uint16_t delay_cs = read_u16(data + pos + 2);
+                control.disposal = (flags >> 2) & 7;
+                // Browsers play delays under 20 ms at 100 ms
+                control.delay_ms = delay_cs < 2 ? 100 : delay_cs * 10u;
+                control.transparent = (flags & 1) ? data[pos + 4] : -1;
+            } else if (label == 0xFF && pos + 16 <= size && data[pos] == 11 &&
+                       (memcmp(data + pos + 1, "NETSCAPE2.0", 11) == 0 ||
+                        memcmp(data + pos + 1, "ANIMEXTS1.0", 11) == 0)) {
+                const uint8_t* loop = data + pos + 12;
+                // Loop count counts repeats after the first play; 0 = forever
+                if (loop[0] >= 3 && loop[1] == 1) {
+                    uint16_t loops = read_u16(loop + 2);
+                    num_plays = loops ? loops + 1u : 0;
+                }
+            }
+            if (!skip_sub_blocks(data, size, pos)) break;
+            continue;
+        }
+
+        if (introducer != 0x2C) break; // Garbage after the last image
+
+        // Image Descriptor
+        if (pos + 9 > size) break;
+        GIFFrameInfo info = control;
+        control = GIFFrameInfo();
+        info.x = read_u16(data + pos);
+        info.y = read_u16(data + pos + 2);
+        info.width = read_u16(data + pos + 4);
+        info.height = read_u16(data + pos + 6);
+        const uint8_t image_flags = data[pos + 8];
+        info.interlaced = (image_flags & 0x40) != 0;
+        pos += 9;
+
+        info.palette = global_palette;
+        info.palette_size = global_size;
+        if (image_flags & 0x80) {
+            info.palette_size = (size_t)2 << (image_flags & 7);
+            if (pos + info.palette_size * 3 > size) break;
+            info.palette = data + pos;
+            pos += info.palette_size * 3;
+        }
+
+        if (pos >= size) break;
+        info.min_code_size = data[pos++];
+        info.blocks = data + pos;
+        const bool complete = skip_sub_blocks(data, size, pos);
+        info.blocks_size = data + pos - info.blocks;
+
+        // A truncated last image still shows what it has
+        if (info.width && info.height && info.width <= 16384 && info.height <= 16384 && info.palette) {
+            delays.push_back(info.delay_ms);
+            infos.push_back(info);
+        }
+        if (!complete) break;
+    }
+
+    if (infos.empty()) return false;
+
+    canvas.assign((size_t)width * height * 4, 0);
+    next_frame = 0;
+    return true;
+}
+
+// Joins the frame's sub-blocks and decodes them into `indices`, returning
+// how many pixels the data covers
+size_t GIFCompositor::DecodeIndices(const GIFFrameInfo& info) {
+    lzw_data.clear();
+    size_t pos = 0;
+    while (pos < info.blocks_size) {
+        size_t len = info.blocks[pos++];
+        if (len == 0) break;
+        len = std::min(len, info.blocks_size - pos);
+        lzw_data.insert(lzw_data.end(), info.blocks + pos, info.blocks + pos + len);
+        pos += len;
+    }
+
+    indices.resize((size_t)info.width * info.height);
+    return lzw_decode(lzw_data.data(), lzw_data.size(), info.min_code_size, indices.data(), indices.size());
+}
+
+bool GIFCompositor::Next(std::vector<uint8_t>& out) {
+    if (infos.empty()) return false;
+
+    // Every loop starts from a transparent canvas
+    if (next_frame == 0)
+        std::fill(canvas.begin(), canvas.end(), 0);
+
+    const GIFFrameInfo& info = infos[next_frame];
+    next_frame = (next_frame + 1) % infos.size();
+
+    // 1. Snapshot for "restore to previous"
+    if (info.disposal == 3) {
+        before_draw = canvas;
+    }
+
+    // 2. Draw the opaque pixels, rows in interlaced pass order if needed
+    const size_t count = DecodeIndices(info);
+    static const uint32_t PASS_START[4] = {0, 4, 2, 1};
+    static const uint32_t PASS_STEP[4] = {8, 8, 4, 2};
+    uint32_t pass = 0;
+    uint32_t y = 0;
+    for (uint32_t row = 0; row < info.height && (size_t)row * info.width < count; row++) {
+        if (info.interlaced) {
+            while (y >= info.height && pass < 3) {
+                pass++;
+                y = PASS_START[pass];
+            }
+            if (y >= info.height) break;
+        } else {
+            y = row;
+        }
+
+        const uint32_t dst_y = info.y + y;
+        if (dst_y < height) {
+            const uint8_t* src = indices.data() + (size_t)row * info.width;
+            const size_t src_count = std::min((size_t)info.width, count - (size_t)row * info.width);
+            uint8_t* dst_row = canvas.data() + (size_t)dst_y * width * 4;
+            for (size_t x = 0; x < src_count && info.x + x < width; x++) {
+                const uint8_t index = src[x];
+                if (index == info.transparent || index >= info.palette_size) continue;
+                const uint8_t* rgb = info.palette + index * 3;
+                uint8_t* dst = dst_row + (info.x + x) * 4;
+                dst[0] = rgb[0];
+                dst[1] = rgb[1];
+                dst[2] = rgb[2];
+                dst[3] = 255;
+            }
+        }
+        if (info.interlaced) y += PASS_STEP[pass];
+    }
+
+    // 3. Hand out a copy of the canvas
+    out.assign(canvas.begin(), canvas.end());
+
+    // 4. Dispose
+    if (info.disposal == 2) {
+        // Browsers clear to transparent rather than the background color
+        for (uint32_t row = info.y; row < std::min(info.y + info.height, height); row++) {
+            if (info.x >= width) break;
+            uint8_t* dst = canvas.data() + ((size_t)row * width + info.x) * 4;
+            memset(dst, 0, (size_t)(std::min(info.x + info.width, width) - info.x) * 4);
+        }
+    } else if (info.disposal == 3) {
+        canvas.swap(before_draw);
+    }
+    return true;
+}
+
+GIFDecoder::GIFDecoder() {}
+
+GIFDecoder::~GIFDecoder() {
+    Free();
+}
+
+void GIFDecoder::Free() {
+    frames.Clear();
+    width = 0;
+    height = 0;
+}
+
+bool GIFDecoder::Load(const uint8_t* data, size_t size, FrameStorage storage, uint32_t max_dim) {
+    Free();
+
+    std::unique_ptr<GIFCompositor> compositor(new GIFCompositor());
+
+    // A streamed animation decodes from its own copy of the file later
+    bool parsed = storage == FrameStorage::STREAMING
+                      ? compositor->Parse(std::vector<uint8_t>(data, data + size))
+                      : compositor->Parse(data, size);
+    if (!parsed) return false;
+
+    width = compositor->GetWidth();
+    height = compositor->GetHeight();
+    num_plays = compositor->GetNumPlays();
+    const std::vector<uint32_t> delays = compositor->GetDelays();
+
+    if (frames.Begin(width, height, delays.size(), storage, max_dim)) {
+        frames.Stream(std::move(compositor), delays);
+        return true;
+    }
+
+    std::vector<uint8_t> canvas;
+    for (uint32_t delay_ms : delays) {
+        compositor->Next(canvas);
+        frames.Add(canvas.data(), delay_ms);
+    }
+    return frames.Finish();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <graphics/graphics.h>
+#include "frame-store.h"
+
+// Image descriptor and graphic control of one frame
+struct GIFFrameInfo {
+    uint32_t x = 0, y = 0;
+    uint32_t width = 0, height = 0;
+    uint8_t disposal = 0;    // 2 = restore to background, 3 = restore to previous
+    int transparent = -1;    // Palette index left undrawn, -1 if none
+    uint32_t delay_ms = 100;
+    bool interlaced = false;
+
+    const uint8_t* palette = nullptr; // RGB triples (local or global table), in the file buffer
+    size_t palette_size = 0;          // Entries
+    uint8_t min_code_size = 0;
+
+    // LZW data sub-blocks (length-prefixed), pointing into the file buffer
+    const uint8_t* blocks = nullptr;
+    size_t blocks_size = 0;
+};
+
+// Walks the blocks of a GIF once, then composites its frames in order.
+// Used to decode every frame up front and, in streaming mode, as the
+// FrameProducer that decodes them on demand.
+class GIFCompositor : public FrameProducer {
+public:
+    // Parses `data`, which must outlive the compositor
+    bool Parse(const uint8_t* data, size_t size);
+    // Takes a copy of the file, so frames can be decoded at any time later
+    bool Parse(std::vector<uint8_t>&& data);
+
+    bool Next(std::vector<uint8_t>& out) override;
+    void Rewind() override { next_frame = 0; }
+    size_t GetMemorySize() const override { return file.size(); }
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    uint32_t GetNumPlays() const { return num_plays; }
+    size_t GetFrameCount() const { return infos.size(); }
+    const std::vector<uint32_t>& GetDelays() const { return delays; }
+
+private:
+    size_t DecodeIndices(const GIFFrameInfo& info);
+
+    std::vector<uint8_t> file; // Owned file data (streaming only)
+    std::vector<GIFFrameInfo> infos;
+    std::vector<uint32_t> delays;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t num_plays = 0;
+
+    // Compositing state between Next() calls
+    std::vector<uint8_t> canvas;
+    std::vector<uint8_t> before_draw;
+    std::vector<uint8_t> lzw_data; // Sub-block payloads joined
+    std::vector<uint8_t> indices;  // Decoded palette indices of the frame
+    size_t next_frame = 0;
+};
+
+// GIF counterpart of APNGDecoder: frames are composited once at load into
+// a FrameStore, so playback never decodes on the video thread.
+class GIFDecoder {
+public:
+    GIFDecoder();
+    ~GIFDecoder();
+
+    // Decodes an in-memory GIF file. CPU only, so it is safe to call off the
+    // graphics thread. `storage` picks where the frames of long animations
+    // live (see FrameStorage); only STREAMING keeps a copy of the file.
+    // Images larger than `max_dim` (0 = no limit) are downscaled to fit.
+    bool Load(const uint8_t* data, size_t size, FrameStorage storage = FrameStorage::RESIDENT, uint32_t max_dim = 0);
+    // Creates textures for decoded frames. Caller must hold the graphics context.
+    bool Upload() { return frames.Upload(); }
+    void Free();
+
+    // Playback, see FrameStore
+    void Tick(uint64_t time_ms) { frames.Tick(time_ms); }
+    void Render(uint64_t time_ms, DeltaCanvas& canvas) const { frames.Render(time_ms, canvas); }
+    gs_texture_t* GetTexture(const DeltaCanvas& canvas) const { return frames.GetTexture(canvas); }
+
+    bool IsAnimated() const { return GetFrameCount() > 1; }
+    bool IsStreaming() const { return frames.IsStreaming(); }
+    size_t GetFrameCount() const { return frames.GetFrameCount(); }
+    size_t GetRamSize() const { return frames.GetRamSize(); }
+    size_t GetVramSize() const { return frames.GetVramSize(); }
+    uint64_t GetDuration() const { return frames.GetDuration(); } // One loop, in ms
+    uint32_t GetNumPlays() const { return num_plays; }               // 0 = forever
+    uint32_t GetWidth() const { return width; }   // Size of the image in the file
+    uint32_t GetHeight() const { return height; }
+
+private:
+    FrameStore frames;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t num_plays = 0;
+};
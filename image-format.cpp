@@ -0,0 +1,70 @@
+#include "image-format.h"
+#include <string.h>
+
+static uint32_t read_u32_be(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static bool probe_webp(const uint8_t* data, size_t size) {
+    // RIFF .... WEBP
+    return size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WEBP", 4) == 0;
+}
+
+static bool probe_png(const uint8_t* data, size_t size) {
+    // 89 50 4E 47 0D 0A 1A 0A
+    static const uint8_t sig[8] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    return size >= 8 && memcmp(data, sig, 8) == 0;
+}
+
+// An APNG announces itself with an acTL chunk before the first IDAT, so only
+// the chunk headers in front of the image data need to be walked.
+bool png_is_animated(const uint8_t* data, size_t size) {
+    if (!probe_png(data, size)) return false;
+
+    size_t pos = 8;
+    while (pos + 8 <= size) {
+        uint32_t len = read_u32_be(data + pos);
+        const uint8_t* type = data + pos + 4;
+        if (memcmp(type, "acTL", 4) == 0) return true;
+        if (memcmp(type, "IDAT", 4) == 0 || memcmp(type, "IEND", 4) == 0) return false;
+        pos += 12 + (size_t)len; // Length + Type + Data + CRC
+    }
+    return false;
+}
+
+static bool probe_apng(const uint8_t* data, size_t size) {
+    return png_is_animated(data, size);
+}
+
+static bool probe_gif(const uint8_t* data, size_t size) {
+    // "GIF87a" or "GIF89a"
+    return size >= 6 && memcmp(data, "GIF8", 4) == 0 &&
+           (data[4] == '7' || data[4] == '9') && data[5] == 'a';
+}
+
+static bool probe_jpeg(const uint8_t* data, size_t size) {
+    // FF D8 FF
+    return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+static bool probe_bmp(const uint8_t* data, size_t size) {
+    // "BM" followed by the file size
+    return size >= 14 && data[0] == 'B' && data[1] == 'M';
+}
+
+// Checked in order: APNG must come before plain PNG
+static const ImageFormatInfo image_formats[] = {
+    {ImageFormat::WEBP, "WebP", FloodAsset::CUSTOM_WEBP,  probe_webp},
+    {ImageFormat::APNG, "APNG", FloodAsset::CUSTOM_APNG,  probe_apng},
+    {ImageFormat::PNG,  "PNG",  FloodAsset::CUSTOM_APNG,  probe_png},
+    {ImageFormat::GIF,  "GIF",  FloodAsset::CUSTOM_GIF,   probe_gif},
+    {ImageFormat::JPEG, "JPEG", FloodAsset::OBS_STANDARD, probe_jpeg},
+    {ImageFormat::BMP,  "BMP",  FloodAsset::OBS_STANDARD, probe_bmp},
+};
+
+const ImageFormatInfo* sniff_image_format(const uint8_t* data, size_t size) {
+    for (const auto& fmt : image_formats) {
+        if (fmt.probe(data, size)) return &fmt;
+    }
+    return nullptr;
+}
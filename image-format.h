@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "asset-cache.h"
+
+// Image container formats recognised from their leading bytes
+enum class ImageFormat {
+    WEBP,
+    APNG,
+    PNG,
+    GIF,
+    JPEG,
+    BMP
+};
+
+// One entry of the format registry
+struct ImageFormatInfo {
+    ImageFormat format;
+    const char* name;
+    FloodAsset::Type loader;                        // Decoder that handles it
+    bool (*probe)(const uint8_t* data, size_t size); // Cheap header-only check
+};
+
+// True if a PNG carries an acTL chunk ahead of its image data (APNG).
+// Only chunk headers are read, nothing is decompressed.
+bool png_is_animated(const uint8_t* data, size_t size);
+
+// Identifies a file from its contents, never its extension, so a WebP saved
+// as .png still reaches WebPDecoder. Returns null if no format matches.
+const ImageFormatInfo* sniff_image_format(const uint8_t* data, size_t size);
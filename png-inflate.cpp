@@ -0,0 +1,92 @@
+#include "png-inflate.h"
+#include <stdlib.h>
+
+#ifdef FLOOD_TUBER_USE_LIBDEFLATE
+#include <libdeflate.h>
+#include <memory>
+#endif
+
+unsigned png_inflate(unsigned char** out, size_t* outsize, const unsigned char* in, size_t insize,
+                     size_t expected_size) {
+#ifdef FLOOD_TUBER_USE_LIBDEFLATE
+    // One decompressor per decode thread; it holds no state between calls
+    struct Free {
+        void operator()(libdeflate_decompressor* d) const { libdeflate_free_decompressor(d); }
+    };
+    thread_local std::unique_ptr<libdeflate_decompressor, Free> decompressor(libdeflate_alloc_decompressor());
+    if (!decompressor) return 83; // lodepng's "memory allocation failed"
+
+    // libdeflate needs the whole output buffer up front. With no hint,
+    // start at a typical PNG ratio and retry larger.
+    size_t capacity = expected_size ? expected_size : (insize < 4096 ? 16384 : insize * 4);
+    for (;;) {
+        unsigned char* buffer = (unsigned char*)malloc(capacity);
+        if (!buffer) return 83;
+
+        size_t actual = 0;
+        libdeflate_result result =
+            libdeflate_zlib_decompress(decompressor.get(), in, insize, buffer, capacity, &actual);
+        if (result == LIBDEFLATE_SUCCESS) {
+            if (actual < capacity) {
+                unsigned char* shrunk = (unsigned char*)realloc(buffer, actual ? actual : 1);
+                if (shrunk) buffer = shrunk;
+            }
+            *out = buffer;
+            *outsize = actual;
+            return 0;
+        }
+        free(buffer);
+        if (result != LIBDEFLATE_INSUFFICIENT_SPACE) return 110; // "inflate decompression failed"
+        if (capacity > ((size_t)-1) / 2) return 83;
+        capacity *= 2;
+    }
+#else
+    (void)expected_size;
+    return lodepng_zlib_decompress(out, outsize, in, insize, &lodepng_default_decompress_settings);
+#endif
+}
+
+#ifdef FLOOD_TUBER_USE_LIBDEFLATE
+// lodepng's custom_zlib hook. lodepng always hands it an empty buffer.
+static unsigned lodepng_inflate_hook(unsigned char** out, size_t* outsize, const unsigned char* in,
+                                     size_t insize, const LodePNGDecompressSettings* settings) {
+    const size_t* expected = (const size_t*)settings->custom_context;
+    return png_inflate(out, outsize, in, insize, expected ? *expected : 0);
+}
+#endif
+
+void png_inflate_setup(LodePNGDecompressSettings* settings, const size_t* expected_size) {
+#ifdef FLOOD_TUBER_USE_LIBDEFLATE
+    settings->custom_zlib = lodepng_inflate_hook;
+    settings->custom_context = expected_size;
+#else
+    (void)settings;
+    (void)expected_size;
+#endif
+}
+
+size_t png_raw_size(unsigned width, unsigned height, unsigned bpp, bool interlaced) {
+    if (!interlaced) return (size_t)height * (((size_t)width * bpp + 7) / 8 + 1);
+
+    static const unsigned ix[7] = {0, 4, 0, 2, 0, 1, 0};
+    static const unsigned iy[7] = {0, 0, 4, 0, 2, 0, 1};
+    static const unsigned dx[7] = {8, 8, 4, 4, 2, 2, 1};
+    static const unsigned dy[7] = {8, 8, 8, 4, 4, 2, 2};
+
+    size_t total = 0;
+    for (int p = 0; p < 7; p++) {
+        unsigned pw = (width + dx[p] - ix[p] - 1) / dx[p];
+        unsigned ph = (height + dy[p] - iy[p] - 1) / dy[p];
+        if (pw == 0 || ph == 0) continue;
+        total += (size_t)ph * (((size_t)pw * bpp + 7) / 8 + 1);
+    }
+    return total;
+}
+
+const char* png_inflate_backend() {
+#ifdef FLOOD_TUBER_USE_LIBDEFLATE
+    return "libdeflate";
+#else
+    return "lodepng";
+#endif
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+#include "lodepng.h"
+
+// Inflate backend for PNG image data. Built with FLOOD_TUBER_USE_LIBDEFLATE
+// the zlib streams go through libdeflate, which inflates several times
+// faster than lodepng's built-in decoder; otherwise lodepng's own inflate is
+// used. Either way the result is identical.
+
+// Inflates a zlib stream into a new buffer owned by the caller (release
+// with free()). `expected_size` is the inflated size when the caller knows
+// it, so the buffer is allocated once; 0 if unknown. Returns a lodepng
+// error code, 0 on success.
+unsigned png_inflate(unsigned char** out, size_t* outsize, const unsigned char* in, size_t insize,
+                     size_t expected_size);
+
+// Points lodepng's decoder at png_inflate. `expected_size` (optional) is
+// used as the size hint and must outlive the decode.
+void png_inflate_setup(LodePNGDecompressSettings* settings, const size_t* expected_size = nullptr);
+
+// Inflated size of a PNG's image data: filter byte plus packed pixels per
+// row, for each Adam7 pass if interlaced
+size_t png_raw_size(unsigned width, unsigned height, unsigned bpp, bool interlaced);
+
+// Name of the compiled-in backend, for the load log
+const char* png_inflate_backend();
@@ -0,0 +1,148 @@
+// Benchmark for png-inflate: inflates the image data of every PNG/APNG
+// given on the command line (files or folders, e.g. data/avatars) with
+// png_inflate() and with lodepng's built-in inflate, checks that both
+// produce the same bytes and prints the time per pass of each.
+//
+//   inflate-bench [--passes N] <file or folder>...
+
+#include "png-inflate.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// One zlib stream: the joined IDAT or fdAT data of a frame
+struct Stream {
+    std::vector<unsigned char> data;
+    size_t expected_size = 0;
+};
+
+static uint32_t read_u32(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// Splits a PNG into its zlib streams, the way APNGCompositor walks it
+static bool collect_streams(const std::vector<unsigned char>& file, std::vector<Stream>& out) {
+    lodepng::State state;
+    unsigned w, h;
+    if (lodepng_inspect(&w, &h, &state, file.data(), file.size())) return false;
+    const unsigned bpp = lodepng_get_bpp(&state.info_png.color);
+    const bool interlaced = state.info_png.interlace_method == 1;
+
+    Stream current;
+    current.expected_size = png_raw_size(w, h, bpp, interlaced);
+    size_t pos = 8;
+    while (pos + 12 <= file.size()) {
+        uint32_t len = read_u32(&file[pos]);
+        if (pos + 12 + (size_t)len > file.size()) break;
+        const unsigned char* type = &file[pos + 4];
+        const unsigned char* data = &file[pos + 8];
+
+        if (memcmp(type, "fcTL", 4) == 0 && len >= 26) {
+            if (!current.data.empty()) out.push_back(std::move(current));
+            current = Stream();
+            current.expected_size = png_raw_size(read_u32(data + 4), read_u32(data + 8), bpp, interlaced);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            current.data.insert(current.data.end(), data, data + len);
+        } else if (memcmp(type, "fdAT", 4) == 0 && len > 4) {
+            current.data.insert(current.data.end(), data + 4, data + len);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + len;
+    }
+    if (!current.data.empty()) out.push_back(std::move(current));
+    return true;
+}
+
+static void add_path(const fs::path& path, std::vector<fs::path>& files) {
+    if (fs::is_directory(path)) {
+        for (const auto& entry : fs::recursive_directory_iterator(path)) {
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (entry.is_regular_file() && (ext == ".png" || ext == ".apng")) files.push_back(entry.path());
+        }
+    } else {
+        files.push_back(path);
+    }
+}
+
+int main(int argc, char** argv) {
+    int passes = 5;
+    std::vector<fs::path> files;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--passes") == 0 && i + 1 < argc)
+            passes = std::max(1, atoi(argv[++i]));
+        else
+            add_path(argv[i], files);
+    }
+    if (files.empty()) {
+        fprintf(stderr, "usage: %s [--passes N] <file or folder>...\n", argv[0]);
+        return 2;
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<Stream> streams;
+    size_t file_bytes = 0, raw_bytes = 0;
+    for (const auto& path : files) {
+        std::ifstream f(path, std::ios::binary);
+        std::vector<unsigned char> file((std::istreambuf_iterator<char>(f)), {});
+        if (!collect_streams(file, streams)) {
+            fprintf(stderr, "skipping %s: not a PNG\n", path.string().c_str());
+            continue;
+        }
+        file_bytes += file.size();
+    }
+    for (const auto& s : streams) raw_bytes += s.expected_size;
+
+    // Both backends must inflate every stream to the same bytes
+    int mismatches = 0;
+    for (const auto& s : streams) {
+        unsigned char *a = nullptr, *b = nullptr;
+        size_t a_size = 0, b_size = 0;
+        unsigned ea = png_inflate(&a, &a_size, s.data.data(), s.data.size(), s.expected_size);
+        unsigned eb = lodepng_zlib_decompress(&b, &b_size, s.data.data(), s.data.size(),
+                                              &lodepng_default_decompress_settings);
+        if (ea != eb || a_size != b_size || (a_size && memcmp(a, b, a_size) != 0)) mismatches++;
+        free(a);
+        free(b);
+    }
+
+    auto time_ms = [&](bool use_png_inflate) {
+        auto start = std::chrono::steady_clock::now();
+        for (int p = 0; p < passes; p++) {
+            for (const auto& s : streams) {
+                unsigned char* out = nullptr;
+                size_t size = 0;
+                if (use_png_inflate)
+                    png_inflate(&out, &size, s.data.data(), s.data.size(), s.expected_size);
+                else
+                    lodepng_zlib_decompress(&out, &size, s.data.data(), s.data.size(),
+                                            &lodepng_default_decompress_settings);
+                free(out);
+            }
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+    };
+    double lodepng_ms = time_ms(false);
+    double backend_ms = time_ms(true);
+
+    printf("%zu files, %zu zlib streams, %.1f MB compressed, %.1f MB inflated\n", files.size(), streams.size(),
+           file_bytes / 1048576.0, raw_bytes / 1048576.0);
+    printf("lodepng:    %8.1f ms per pass\n", lodepng_ms);
+    printf("%-11s %8.1f ms per pass (%.2fx)\n", (std::string(png_inflate_backend()) + ":").c_str(), backend_ms,
+           backend_ms > 0 ? lodepng_ms / backend_ms : 0.0);
+    if (mismatches) {
+        printf("%d streams inflated differently\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
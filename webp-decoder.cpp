@@ -1,11 +1,46 @@
 #include "webp-decoder.h"
-#include <fstream>
 #include <vector>
 #include <webp/decode.h>
 #include <webp/demux.h>
 
 #define BLOG(level, format, ...) blog(level, "[WebP-Decoder] " format, ##__VA_ARGS__)
 
+// Streams frames from a private copy of the file. WebPAnimDecoder already
+// keeps the previous canvas for blending, so frames come out in order.
+class WebPProducer : public FrameProducer {
+public:
+    WebPProducer(const uint8_t* data, size_t size, const WebPAnimDecoderOptions& options)
+        : file(data, data + size) {
+        WebPData webp_data;
+        webp_data.bytes = file.data();
+        webp_data.size = file.size();
+        dec = WebPAnimDecoderNew(&webp_data, &options);
+        if (dec) WebPAnimDecoderGetInfo(dec, &info);
+    }
+    ~WebPProducer() override {
+        if (dec) WebPAnimDecoderDelete(dec);
+    }
+    size_t GetMemorySize() const override { return file.size(); }
+
+    bool IsValid() const { return dec != nullptr; }
+
+    bool Next(std::vector<uint8_t>& canvas) override {
+        if (!WebPAnimDecoderHasMoreFrames(dec)) WebPAnimDecoderReset(dec);
+
+        uint8_t* buf;
+        int timestamp;
+        if (!WebPAnimDecoderGetNext(dec, &buf, &timestamp)) return false;
+        canvas.assign(buf, buf + (size_t)info.canvas_width * info.canvas_height * 4);
+        return true;
+    }
+    void Rewind() override { WebPAnimDecoderReset(dec); }
+
+private:
+    std::vector<uint8_t> file;
+    WebPAnimDecoder* dec = nullptr;
+    WebPAnimInfo info = {};
+};
+
 WebPDecoder::WebPDecoder() {}
 
 WebPDecoder::~WebPDecoder() {
@@ -13,43 +48,61 @@ WebPDecoder::~WebPDecoder() {
 }
 
 void WebPDecoder::VerifyFree() {
-    obs_enter_graphics();
-    for (auto& frame : frames) {
-        if (frame.texture) {
-            gs_texture_destroy(frame.texture);
-        }
-    }
-    obs_leave_graphics();
-    frames.clear();
+    frames.Clear();
     is_animated = false;
     width = 0;
     height = 0;
-    total_duration = 0;
 }
 
-bool WebPDecoder::Load(const char* path) {
+bool WebPDecoder::Load(const uint8_t* data, size_t size, FrameStorage storage, uint32_t max_dim) {
     VerifyFree();
+    if (!data || size == 0) return false;
+    return DecodeData(data, size, storage, max_dim);
+}
 
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        BLOG(LOG_WARNING, "Failed to open file: %s", path);
+// Still images skip WebPAnimDecoder, which would composite the single
+// frame onto a canvas of its own, and decode straight into the frame's
+// buffer. A capped image is downscaled by libwebp while decoding, so no
+// full-size copy exists at any point.
+bool WebPDecoder::DecodeStill(const uint8_t* data, size_t size, WebPDecoderConfig& config, uint32_t max_dim) {
+    width = config.input.width;
+    height = config.input.height;
+    uint32_t texture_width = width;
+    uint32_t texture_height = height;
+    if (Downscaler::Fit(width, height, max_dim, texture_width, texture_height)) {
+        config.options.use_scaling = 1;
+        config.options.scaled_width = (int)texture_width;
+        config.options.scaled_height = (int)texture_height;
+    }
+    config.options.use_threads = 1;
+
+    std::vector<uint8_t> pixels((size_t)texture_width * texture_height * 4);
+    config.output.colorspace = MODE_RGBA;
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba = pixels.data();
+    config.output.u.RGBA.stride = (int)texture_width * 4;
+    config.output.u.RGBA.size = pixels.size();
+
+    VP8StatusCode status = WebPDecode(data, size, &config);
+    WebPFreeDecBuffer(&config.output);
+    if (status != VP8_STATUS_OK) {
+        BLOG(LOG_WARNING, "Failed to decode WebP image (status %d)", (int)status);
         return false;
     }
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    if (size <= 0) return false;
+    BLOG(LOG_DEBUG, "Decoding WebP: %dx%d, still image", width, height);
+    frames.AddStill(std::move(pixels), texture_width, texture_height);
+    return frames.Finish();
+}
 
-    std::vector<uint8_t> buffer(size);
-    if (!file.read((char*)buffer.data(), size)) {
+bool WebPDecoder::DecodeData(const uint8_t* data, size_t size, FrameStorage storage, uint32_t max_dim) {
+    WebPDecoderConfig config;
+    if (!WebPInitDecoderConfig(&config) || WebPGetFeatures(data, size, &config.input) != VP8_STATUS_OK) {
+        BLOG(LOG_WARNING, "Failed to read WebP header");
         return false;
     }
+    if (!config.input.has_animation) return DecodeStill(data, size, config, max_dim);
 
-    return DecodeData(buffer.data(), (size_t)size);
-}
-
-bool WebPDecoder::DecodeData(const uint8_t* data, size_t size) {
     WebPData webp_data;
     webp_data.bytes = data;
     webp_data.size = size;
@@ -57,6 +110,9 @@ bool WebPDecoder::DecodeData(const uint8_t* data, size_t size) {
     WebPAnimDecoderOptions dec_options;
     WebPAnimDecoderOptionsInit(&dec_options);
     dec_options.color_mode = MODE_RGBA;
+    // Lossy frames filter on a second thread. Also used by the streaming
+    // producer, which decodes on a worker as well.
+    dec_options.use_threads = 1;
 
     WebPAnimDecoder* dec = WebPAnimDecoderNew(&webp_data, &dec_options);
     if (dec == NULL) {
@@ -78,59 +134,41 @@ bool WebPDecoder::DecodeData(const uint8_t* data, size_t size) {
 
     BLOG(LOG_INFO, "Decoding WebP: %dx%d, Frames: %d, Loops: %d", width, height, anim_info.frame_count, loop_count);
 
+    // A streamed animation decodes during playback. Frame durations then
+    // come from the demuxer, so nothing is decoded here.
+    if (frames.Begin(width, height, anim_info.frame_count, storage, max_dim)) {
+        std::vector<uint32_t> durations;
+        const WebPDemuxer* demux = WebPAnimDecoderGetDemuxer(dec);
+        WebPIterator iter;
+        for (uint32_t i = 1; i <= anim_info.frame_count; i++) {
+            if (!WebPDemuxGetFrame(demux, (int)i, &iter)) break;
+            durations.push_back(iter.duration > 0 ? (uint32_t)iter.duration : 0);
+            WebPDemuxReleaseIterator(&iter);
+        }
+        WebPAnimDecoderDelete(dec);
+
+        std::unique_ptr<WebPProducer> webp(new WebPProducer(data, size, dec_options));
+        if (!webp->IsValid() || durations.size() != anim_info.frame_count) {
+            BLOG(LOG_WARNING, "Failed to set up WebP streaming");
+            return false;
+        }
+        frames.Stream(std::move(webp), durations);
+        return true;
+    }
+
+    // We must decode ALL frames to get correct blending.
+    // The decoder reuses its canvas; the store copies out what it keeps.
     int prev_timestamp = 0;
-    
-    // We must decode ALL frames to get correct blending
-    obs_enter_graphics();
-    
     while (WebPAnimDecoderHasMoreFrames(dec)) {
         uint8_t* buf;
         int timestamp;
         if (!WebPAnimDecoderGetNext(dec, &buf, &timestamp)) {
             break;
         }
-
-        // Create texture for this frame
-        gs_texture_t* tex = gs_texture_create(width, height, GS_RGBA, 1, (const uint8_t**)&buf, GS_DYNAMIC);
-        if (!tex) {
-            BLOG(LOG_WARNING, "Failed to create texture for frame");
-            continue;
-        }
-
-        WebPFrame frame;
-        frame.texture = tex;
-        frame.timestamp_ms = timestamp;
-        frame.duration_ms = timestamp - prev_timestamp;
-        
-        frames.push_back(frame);
+        frames.Add(buf, (uint32_t)(timestamp - prev_timestamp));
         prev_timestamp = timestamp;
     }
 
-    obs_leave_graphics();
     WebPAnimDecoderDelete(dec);
-
-    total_duration = prev_timestamp;
-    return !frames.empty();
-}
-
-gs_texture_t* WebPDecoder::GetTextureForTime(uint64_t time_ms) {
-    if (frames.empty()) return NULL;
-    if (!is_animated) return frames[0].texture;
-
-    // Handle looping
-    if (total_duration > 0) {
-        time_ms %= total_duration;
-    }
-
-    // Find the frame that covers this timestamp.
-    // timestamp_ms is the END time of the frame.
-    // So we want the first frame where frame.timestamp_ms > time_ms
-    for (const auto& frame : frames) {
-        if (frame.timestamp_ms > (int)time_ms) {
-            return frame.texture;
-        }
-    }
-
-    // Fallback to last frame (should be covered by loop logic, but just in case)
-    return frames.back().texture;
+    return frames.Finish();
 }
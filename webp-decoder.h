@@ -1,44 +1,55 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <obs-module.h>
 #include <graphics/graphics.h>
+#include "frame-store.h"
 
-struct WebPFrame {
-    gs_texture_t* texture;
-    int duration_ms;  // Duration of this frame in milliseconds
-    int timestamp_ms; // Cumulative timestamp when this frame ends
-};
+struct WebPDecoderConfig;
 
 class WebPDecoder {
 public:
     WebPDecoder();
     ~WebPDecoder();
 
-    // Load a WebP file from path
-    bool Load(const char* path);
+    // Decode an in-memory WebP file. CPU only, so it is safe to call off
+    // the graphics thread. `storage` picks where the frames of long
+    // animations live (see FrameStorage); only STREAMING keeps a copy of
+    // the file, otherwise the buffer is not referenced afterwards. Images
+    // larger than `max_dim` (0 = no limit) are downscaled to fit before upload.
+    bool Load(const uint8_t* data, size_t size, FrameStorage storage = FrameStorage::RESIDENT, uint32_t max_dim = 0);
+
+    // Create textures for all decoded frames and drop the CPU copies.
+    // Caller must hold the graphics context.
+    bool Upload() { return frames.Upload(); }
 
     // Free all resources
     void VerifyFree();
 
-    // Get current texture based on elapsed time (in milliseconds)
-    // Returns the texture and updates frame index internally if needed,
-    // but typically we pass time and get texture.
-    gs_texture_t* GetTextureForTime(uint64_t time_ms);
+    // Playback, see FrameStore
+    void Tick(uint64_t time_ms) { frames.Tick(time_ms); }
+    gs_texture_t* GetTexture(const DeltaCanvas& canvas) const { return frames.GetTexture(canvas); }
+    void Render(uint64_t time_ms, DeltaCanvas& canvas) const { frames.Render(time_ms, canvas); }
 
     bool IsAnimated() const { return is_animated; }
-    int GetWidth() const { return width; }
+    bool IsStreaming() const { return frames.IsStreaming(); }
+    size_t GetFrameCount() const { return frames.GetFrameCount(); }
+    size_t GetRamSize() const { return frames.GetRamSize(); }
+    size_t GetVramSize() const { return frames.GetVramSize(); }
+    uint64_t GetDuration() const { return frames.GetDuration(); } // One loop, in ms
+    int GetLoopCount() const { return loop_count; }                  // 0 = forever
+    int GetWidth() const { return width; } // Size of the image in the file
     int GetHeight() const { return height; }
 
 private:
-    std::vector<WebPFrame> frames;
+    FrameStore frames;
     bool is_animated = false;
     int width = 0;
     int height = 0;
     int loop_count = 0;
-    int total_duration = 0;
 
-    // Helper to decode raw data
-    bool DecodeData(const uint8_t* data, size_t size);
+    bool DecodeData(const uint8_t* data, size_t size, FrameStorage storage, uint32_t max_dim);
+    bool DecodeStill(const uint8_t* data, size_t size, WebPDecoderConfig& config, uint32_t max_dim);
 };
@@ -0,0 +1,81 @@
+#include "worker-pool.h"
+#include <obs-module.h>
+
+#define BLOG(level, format, ...) blog(level, "[Worker-Pool] " format, ##__VA_ARGS__)
+
+WorkerPool& WorkerPool::Get() {
+    static WorkerPool pool;
+    return pool;
+}
+
+// One thread per core, so a full avatar decodes in about the time of its
+// largest image
+size_t WorkerPool::ThreadCount() {
+    size_t n = std::thread::hardware_concurrency();
+    if (n < 1) n = 1;
+    if (n > 16) n = 16;
+    return n;
+}
+
+WorkerPool::~WorkerPool() {
+    Shutdown();
+}
+
+void WorkerPool::Submit(std::function<void()> task, bool background) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) return;
+
+    if (threads.empty()) {
+        size_t count = ThreadCount();
+        for (size_t i = 0; i < count; i++)
+            threads.emplace_back(&WorkerPool::Run, this);
+        BLOG(LOG_INFO, "Started %zu background decode threads", count);
+    }
+    (background ? background_queue : queue).push_back(std::move(task));
+    cv.notify_one();
+}
+
+void WorkerPool::Shutdown() {
+    std::deque<std::function<void()>> dropped, dropped_background;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        dropped.swap(queue);
+        dropped_background.swap(background_queue);
+    }
+    cv.notify_all();
+
+    for (auto& t : threads) {
+        if (t.joinable()) t.join();
+    }
+    threads.clear();
+    // Dropped tasks release their captured state here, outside the lock
+}
+
+void WorkerPool::Run() {
+    for (;;) {
+        std::function<void()> task;
+        bool background;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] {
+                return stopping || !queue.empty() ||
+                       (!background_queue.empty() && running_background < MAX_BACKGROUND_THREADS);
+            });
+            if (stopping) return;
+            background = queue.empty();
+            auto& source = background ? background_queue : queue;
+            task = std::move(source.front());
+            source.pop_front();
+            if (background) running_background++;
+        }
+        task();
+
+        if (background) {
+            std::lock_guard<std::mutex> lock(mutex);
+            running_background--;
+            // A thread may be waiting for this background slot
+            cv.notify_one();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Process-wide pool of background workers used to decode avatar images off
+// the graphics thread, one task per image slot. Tasks must never enter the
+// graphics context for long; texture uploads are handed back to the video
+// tick instead.
+class WorkerPool {
+public:
+    static const size_t MAX_BACKGROUND_THREADS = 2;
+
+    static WorkerPool& Get();
+
+    // Queue a task. Threads are started lazily on first use.
+    // Background tasks (e.g. library prewarm) only run when no regular
+    // task is waiting, and on at most MAX_BACKGROUND_THREADS threads at a
+    // time, so they never delay loading what is on screen.
+    void Submit(std::function<void()> task, bool background = false);
+
+    // Drop queued tasks and join all threads (called on module unload)
+    void Shutdown();
+
+private:
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    void Run();
+
+    static size_t ThreadCount();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> queue;
+    std::deque<std::function<void()>> background_queue;
+    std::vector<std::thread> threads;
+    size_t running_background = 0; // Background tasks currently running
+    bool stopping = false;
+};